@@ -11,14 +11,132 @@
 #include "web_interface.h"
 #include <WiFi.h>
 #include "esp_camera.h"
+#include "SerialPortBinary.h"
 WiFiServer server(100);
 
+#define SerialPortBinary_en 0 //1：forward app commands to the car as binary frames when they have an exact binary form
+
 #define RXD2 33
 #define TXD2 4
 CameraWebServer_AP CameraWebServerAP;
 
 bool WA_en = false;
 
+/*
+  UNO link speed negotiation：both ends start at 9600. Once a second the link is stepped up one rate (N 25), confirmed
+  by a CRC-checked probe (N 26) at the new rate, and kept at the highest rate whose probe came back.
+  At a raised rate the probe doubles as keepalive：three missed probes drop back to 9600 and the stepping starts over.
+*/
+#define SerialPortLink_en 1
+#define SerialPortLink_Pattern "U*U*3f9C" //0x55/0x2A bit patterns
+#define SerialPortLink_Timeout 200
+static const uint32_t SerialPortLink_Rate[] = {9600, 57600, 115200, 250000};
+enum SerialPortLinkState
+{
+  Link_Idle,
+  Link_Step,  //Waiting for {BR_ok}
+  Link_Probe, //Waiting for the probe echo
+};
+static SerialPortLinkState Link_State = Link_Idle;
+static uint8_t Link_Index = 0; //Confirmed rate
+static uint8_t Link_Next = 0;  //Rate being probed
+static uint8_t Link_Max = sizeof(SerialPortLink_Rate) / sizeof(SerialPortLink_Rate[0]) - 1;
+static uint8_t Link_Miss = 0;
+static unsigned long Link_Millis = 0;
+static unsigned long Link_Micros = 0;
+
+static void SerialPortLink_Probe(void)
+{
+  Link_Millis = millis();
+  Link_Micros = micros();
+  Serial2.printf("{\"H\":\"%s\",\"N\":26,\"D1\":%u}", SerialPortLink_Pattern,
+                 SerialPortBinary_CRC8((const uint8_t *)SerialPortLink_Pattern, strlen(SerialPortLink_Pattern)));
+  Link_State = Link_Probe;
+}
+void SerialPortLink_Update(void)
+{
+#if SerialPortLink_en
+  switch (Link_State)
+  {
+  case Link_Idle:
+    if (millis() - Link_Millis < 1000)
+      return;
+    Link_Millis = millis();
+    if (Link_Index < Link_Max)
+    {
+      Link_Next = Link_Index + 1;
+      Serial2.printf("{\"H\":\"BR\",\"N\":25,\"D1\":%u}", Link_Next);
+      Link_State = Link_Step;
+    }
+    else if (Link_Index > 0)
+    {
+      Link_Next = Link_Index;
+      SerialPortLink_Probe();
+    }
+    break;
+  case Link_Step:
+    if (millis() - Link_Millis > SerialPortLink_Timeout) //No answer：the car may not support it, or is still at another rate
+    {
+      if (++Link_Miss >= 5)
+      {
+        Link_Miss = 0;
+        Link_Max = Link_Index;
+      }
+      Link_State = Link_Idle;
+    }
+    break;
+  case Link_Probe:
+    if (millis() - Link_Millis > SerialPortLink_Timeout)
+    {
+      if (Link_Next != Link_Index) //New rate failed：go back and stay there
+      {
+        Serial2.updateBaudRate(SerialPortLink_Rate[Link_Index]);
+        Link_Max = Link_Index;
+        Serial.printf("[Link] %lu failed\n", (unsigned long)SerialPortLink_Rate[Link_Next]);
+      }
+      else if (++Link_Miss >= 3) //Keepalive lost：start over from 9600
+      {
+        Link_Miss = 0;
+        Link_Index = 0;
+        Link_Max = sizeof(SerialPortLink_Rate) / sizeof(SerialPortLink_Rate[0]) - 1;
+        Serial2.updateBaudRate(SerialPortLink_Rate[0]);
+        Serial.println("[Link] lost");
+      }
+      Link_State = Link_Idle;
+    }
+    break;
+  }
+#endif
+}
+/*Negotiation replies from the car are taken here and not forwarded to the client*/
+bool SerialPortLink_Reply(const String &Reply)
+{
+  if (Reply.startsWith("{BR_"))
+  {
+    if (Link_State == Link_Step && Reply.equals("{BR_ok}"))
+    {
+      Link_Miss = 0;
+      Serial2.updateBaudRate(SerialPortLink_Rate[Link_Next]);
+      delay(5); //Let the car reopen its UART
+      SerialPortLink_Probe();
+    }
+    return true;
+  }
+  if (Reply.startsWith("{" SerialPortLink_Pattern "_"))
+  {
+    String expect = String("{" SerialPortLink_Pattern "_") + SerialPortBinary_CRC8((const uint8_t *)SerialPortLink_Pattern, strlen(SerialPortLink_Pattern)) + "}";
+    if (Link_State == Link_Probe && Reply.equals(expect))
+    {
+      Serial.printf("[Link] %lu rtt=%luus\n", (unsigned long)SerialPortLink_Rate[Link_Next], (unsigned long)(micros() - Link_Micros)); //Command round trip at this rate
+      Link_Index = Link_Next;
+      Link_Miss = 0;
+      Link_State = Link_Idle;
+    }
+    return true;
+  }
+  return false;
+}
+
 void SocketServer_Test(void)
 {
   static bool ED_client = true;
@@ -56,7 +174,14 @@ void SocketServer_Test(void)
           }
           else
           {
-            Serial2.print(readBuff);
+#if SerialPortBinary_en
+            uint8_t frame[SerialPortBinary_FrameMax];
+            size_t length = SerialPortBinary_FromJson(readBuff.c_str(), frame, sizeof(frame));
+            if (length > 0)
+              Serial2.write(frame, length);
+            else
+#endif
+              Serial2.print(readBuff);
           }
           //Serial2.print(readBuff);
           readBuff = "";
@@ -68,11 +193,15 @@ void SocketServer_Test(void)
         sendBuff += c;
         if (c == '}') //接收到结束字符
         {
-          client.print(sendBuff);
-          Serial.print(sendBuff); //从串口打印
+          if (false == SerialPortLink_Reply(sendBuff))
+          {
+            client.print(sendBuff);
+            Serial.print(sendBuff); //从串口打印
+          }
           sendBuff = "";
         }
       }
+      SerialPortLink_Update();
 
       static unsigned long Heartbeat_time = 0;
       if (millis() - Heartbeat_time > 1000) //心跳频率
@@ -131,7 +260,11 @@ void FactoryTest(void)
     readBuff += c;
     if (c == '}') //接收到结束字符
     {
-      if (true == readBuff.equals("{BT_detection}"))
+      if (true == SerialPortLink_Reply(readBuff))
+      {
+        //Link negotiation reply
+      }
+      else if (true == readBuff.equals("{BT_detection}"))
       {
         Serial2.print("{BT_OK}");
         Serial.println("Factory...");
@@ -209,6 +342,7 @@ void loop()
 {
   SocketServer_Test();
   FactoryTest();
+  SerialPortLink_Update();
 }
 
 /*
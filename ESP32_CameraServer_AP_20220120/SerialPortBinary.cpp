@@ -0,0 +1,265 @@
+/*
+ * @Description: Binary command frames for the Smart Robot Car serial protocol
+ * @Author: Elegoo
+ */
+#include <string.h>
+#include "SerialPortBinary.h"
+
+/*Fields carried by each N：must match SerialPortBinary_Layout() in ApplicationFunctionSet_xxx0.cpp*/
+uint8_t SerialPortBinary_Layout(uint8_t N)
+{
+  switch (N)
+  {
+  case 1:
+    return SerialPortBinary_D1 | SerialPortBinary_D2 | SerialPortBinary_D3;
+  case 2:
+    return SerialPortBinary_D1 | SerialPortBinary_D2 | SerialPortBinary_T;
+  case 3:
+  case 4:
+  case 5:
+  case 102:
+    return SerialPortBinary_D1 | SerialPortBinary_D2;
+  case 7:
+  case 29:
+    return SerialPortBinary_D1 | SerialPortBinary_D2 | SerialPortBinary_D3 | SerialPortBinary_D4 | SerialPortBinary_T;
+  case 8:
+  case 27: //Gains above 255 (the default Kd is 300) have no binary form and stay JSON
+    return SerialPortBinary_D1 | SerialPortBinary_D2 | SerialPortBinary_D3 | SerialPortBinary_D4;
+  case 21:
+  case 22:
+  case 24:
+  case 25:
+  case 26:
+  case 28:
+  case 101:
+  case 105:
+  case 106:
+    return SerialPortBinary_D1;
+  case 23:
+  case 100:
+  case 110:
+    return 0;
+  default:
+    return 0xFF; //No binary form
+  }
+}
+
+uint8_t SerialPortBinary_CRC8(const uint8_t *p, size_t Length)
+{
+  uint8_t crc = 0;
+  while (Length--)
+  {
+    crc ^= *p++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  return crc;
+}
+
+size_t SerialPortBinary_Encode(const SerialPortBinaryCommand *Command, uint8_t *Frame, size_t Size)
+{
+  uint8_t layout = SerialPortBinary_Layout(Command->N);
+  if (layout == 0xFF || Command->N & SerialPortBinary_H || Command->H > 255)
+    return 0;
+
+  uint8_t payload[9];
+  size_t length = 0;
+  payload[length++] = Command->N | ((Command->H >= 0) ? SerialPortBinary_H : 0);
+  if (Command->H >= 0)
+    payload[length++] = Command->H;
+  if (layout & SerialPortBinary_D1)
+    payload[length++] = Command->D1;
+  if (layout & SerialPortBinary_D2)
+    payload[length++] = Command->D2;
+  if (layout & SerialPortBinary_D3)
+    payload[length++] = Command->D3;
+  if (layout & SerialPortBinary_D4)
+    payload[length++] = Command->D4;
+  if (layout & SerialPortBinary_T)
+  {
+    payload[length++] = Command->T & 0xFF;
+    payload[length++] = Command->T >> 8;
+  }
+  payload[length] = SerialPortBinary_CRC8(payload, length);
+  length++;
+
+  size_t n = 0;
+  if (Size < 2)
+    return 0;
+  Frame[n++] = SerialPortSLIP_END;
+  for (size_t i = 0; i < length; i++)
+  {
+    uint8_t c = payload[i];
+    if (c == SerialPortSLIP_END || c == SerialPortSLIP_ESC)
+    {
+      if (n + 2 > Size - 1)
+        return 0;
+      Frame[n++] = SerialPortSLIP_ESC;
+      Frame[n++] = (c == SerialPortSLIP_END) ? SerialPortSLIP_ESC_END : SerialPortSLIP_ESC_ESC;
+    }
+    else
+    {
+      if (n + 1 > Size - 1)
+        return 0;
+      Frame[n++] = c;
+    }
+  }
+  Frame[n++] = SerialPortSLIP_END;
+  return n;
+}
+
+bool SerialPortBinary_Decode(const uint8_t *Frame, size_t Length, SerialPortBinaryCommand *Command)
+{
+  uint8_t payload[SerialPortBinary_FrameMax];
+  size_t length = 0;
+  bool escape = false;
+  for (size_t i = 0; i < Length; i++)
+  {
+    uint8_t c = Frame[i];
+    if (c == SerialPortSLIP_END)
+      continue;
+    if (c == SerialPortSLIP_ESC)
+    {
+      escape = true;
+      continue;
+    }
+    if (escape)
+    {
+      escape = false;
+      c = (c == SerialPortSLIP_ESC_END) ? SerialPortSLIP_END : (c == SerialPortSLIP_ESC_ESC) ? SerialPortSLIP_ESC : c;
+    }
+    if (length == sizeof(payload))
+      return false;
+    payload[length++] = c;
+  }
+  if (length < 2 || SerialPortBinary_CRC8(payload, length - 1) != payload[length - 1])
+    return false;
+
+  const uint8_t *p = payload;
+  uint8_t opcode = *p++;
+  uint8_t layout = SerialPortBinary_Layout(opcode & ~SerialPortBinary_H);
+  if (layout == 0xFF)
+    return false;
+  size_t expect = 2 + ((opcode & SerialPortBinary_H) ? 1 : 0) + ((layout & SerialPortBinary_T) ? 2 : 0);
+  for (uint8_t i = 0; i < 4; i++)
+    expect += (layout >> i) & 1;
+  if (length != expect)
+    return false;
+
+  memset(Command, 0, sizeof(SerialPortBinaryCommand));
+  Command->N = opcode & ~SerialPortBinary_H;
+  Command->H = (opcode & SerialPortBinary_H) ? *p++ : -1;
+  if (layout & SerialPortBinary_D1)
+    Command->D1 = *p++;
+  if (layout & SerialPortBinary_D2)
+    Command->D2 = *p++;
+  if (layout & SerialPortBinary_D3)
+    Command->D3 = *p++;
+  if (layout & SerialPortBinary_D4)
+    Command->D4 = *p++;
+  if (layout & SerialPortBinary_T)
+    Command->T = p[0] | (p[1] << 8);
+  return true;
+}
+
+/*Read a non-negative integer no larger than Max, returns NULL otherwise*/
+static const char *SerialPortBinary_Number(const char *p, long Max, long *Value)
+{
+  if (*p < '0' || *p > '9')
+    return NULL;
+  *Value = 0;
+  while (*p >= '0' && *p <= '9')
+  {
+    *Value = *Value * 10 + (*p++ - '0');
+    if (*Value > Max)
+      return NULL;
+  }
+  return p;
+}
+
+size_t SerialPortBinary_FromJson(const char *Json, uint8_t *Frame, size_t Size)
+{
+  SerialPortBinaryCommand command;
+  uint8_t present = 0;
+  bool has_N = false;
+  memset(&command, 0, sizeof(command));
+  command.H = -1;
+
+  const char *p = Json;
+  while (*p == ' ')
+    p++;
+  if (*p++ != '{')
+    return 0;
+  while (*p == ' ')
+    p++;
+  while (*p != '}')
+  {
+    char key[3];
+    size_t k = 0;
+    long value;
+    if (*p++ != '"')
+      return 0;
+    while (*p != '"')
+    {
+      if (*p == '\0' || k == sizeof(key) - 1)
+        return 0;
+      key[k++] = *p++;
+    }
+    key[k] = '\0';
+    p++;
+    while (*p == ' ')
+      p++;
+    if (*p++ != ':')
+      return 0;
+    while (*p == ' ')
+      p++;
+
+    if (strcmp(key, "H") == 0)
+    {
+      const char *begin = ++p - 1;
+      if (*begin != '"' || (p = SerialPortBinary_Number(p, 255, &value)) == NULL || *p++ != '"')
+        return 0;
+      if (begin[1] == '0' && p - begin != 3) //Leading zero would not come back as the same text
+        return 0;
+      command.H = value;
+    }
+    else
+    {
+      if ((p = SerialPortBinary_Number(p, strcmp(key, "T") == 0 ? 65535 : 255, &value)) == NULL)
+        return 0;
+      if (strcmp(key, "N") == 0)
+      {
+        if (value > 127)
+          return 0;
+        command.N = value;
+        has_N = true;
+      }
+      else if (strcmp(key, "T") == 0)
+      {
+        command.T = value;
+        present |= SerialPortBinary_T;
+      }
+      else if (key[0] == 'D' && key[1] >= '1' && key[1] <= '4' && key[2] == '\0')
+      {
+        (&command.D1)[key[1] - '1'] = value;
+        present |= 1 << (key[1] - '1');
+      }
+      else
+        return 0;
+    }
+    while (*p == ' ')
+      p++;
+    if (*p == ',')
+    {
+      p++;
+      while (*p == ' ')
+        p++;
+    }
+    else if (*p != '}')
+      return 0;
+  }
+
+  if (false == has_N || (present & ~SerialPortBinary_Layout(command.N)) != 0)
+    return 0;
+  return SerialPortBinary_Encode(&command, Frame, Size);
+}
@@ -0,0 +1,52 @@
+/*
+ * @Description: Binary command frames for the Smart Robot Car serial protocol
+ * @Author: Elegoo
+ *
+ * Host-side encoder/decoder, kept free of Arduino dependencies so it builds on the bridge and on a PC alike.
+ * Frame：END opcode [H] fields CRC-8 END (SLIP), see ApplicationFunctionSet_SerialPortBinary() on the car.
+ */
+
+#ifndef _SerialPortBinary_H
+#define _SerialPortBinary_H
+#include <stddef.h>
+#include <stdint.h>
+
+#define SerialPortBinary_FrameMax 22 //Largest encoded frame, SLIP escapes included
+
+#define SerialPortSLIP_END 0xC0
+#define SerialPortSLIP_ESC 0xDB
+#define SerialPortSLIP_ESC_END 0xDC
+#define SerialPortSLIP_ESC_ESC 0xDD
+
+#define SerialPortBinary_H 0x80
+#define SerialPortBinary_D1 0x01
+#define SerialPortBinary_D2 0x02
+#define SerialPortBinary_D3 0x04
+#define SerialPortBinary_D4 0x08
+#define SerialPortBinary_T 0x10
+
+struct SerialPortBinaryCommand
+{
+  uint8_t N;
+  int16_t H; //-1：no serial number
+  uint8_t D1;
+  uint8_t D2;
+  uint8_t D3;
+  uint8_t D4;
+  uint16_t T;
+};
+
+uint8_t SerialPortBinary_Layout(uint8_t N);
+uint8_t SerialPortBinary_CRC8(const uint8_t *p, size_t Length);
+/*Encode one command into a SLIP frame, returns its length (0：does not fit in Size)*/
+size_t SerialPortBinary_Encode(const SerialPortBinaryCommand *Command, uint8_t *Frame, size_t Size);
+/*Decode one SLIP frame (END bytes optional), returns false on a bad length or CRC*/
+bool SerialPortBinary_Decode(const uint8_t *Frame, size_t Length, SerialPortBinaryCommand *Command);
+/*
+  Translate a JSON command frame such as {"H":"12","N":102,"D1":1,"D2":250} into a binary frame.
+  Returns 0 when the frame has no exact binary form (unknown N or key, nested value, out of range number,
+  H that is not the decimal text of 0~255); the caller then sends the JSON frame unchanged.
+*/
+size_t SerialPortBinary_FromJson(const char *Json, uint8_t *Frame, size_t Size);
+
+#endif
@@ -13,8 +13,8 @@
 #include "ApplicationFunctionSet_xxx0.h"
 #include "DeviceDriverSet_xxx0.h"
 
-#include "ArduinoJson-v6.11.1.h" //ArduinoJson
 #include "MPU6050_getdata.h"
+#include <EEPROM.h>
 
 #define _is_print 1
 #define _Test_print 0
@@ -24,13 +24,14 @@ ApplicationFunctionSet Application_FunctionSet;
 /*Hardware device object list*/
 MPU6050_getdata AppMPU6050getdata;
 DeviceDriverSet_RBGLED AppRBG_LED;
-DeviceDriverSet_Key AppKey;
-DeviceDriverSet_ITR20001 AppITR20001;
+DeviceDriverSet_Key<DeviceDriverSet_Board> AppKey;
+DeviceDriverSet_ADC AppADC;
+DeviceDriverSet_ITR20001<DeviceDriverSet_Board> AppITR20001;
 DeviceDriverSet_Voltage AppVoltage;
 
-DeviceDriverSet_Motor AppMotor;
-DeviceDriverSet_ULTRASONIC AppULTRASONIC;
-DeviceDriverSet_Servo AppServo;
+DeviceDriverSet_Motor<DeviceDriverSet_Board> AppMotor;
+DeviceDriverSet_ULTRASONIC<DeviceDriverSet_Board> AppULTRASONIC;
+DeviceDriverSet_Servo<DeviceDriverSet_Board> AppServo;
 DeviceDriverSet_IRrecv AppIRrecv;
 /*f(x) int */
 static boolean
@@ -41,15 +42,6 @@ function_xxx(long x, long s, long e) //f(x)
   else
     return false;
 }
-static void
-delay_xxx(uint16_t _ms)
-{
-  wdt_reset();
-  for (unsigned long i = 0; i < _ms; i++)
-  {
-    delay(1);
-  }
-}
 
 /*Movement Direction Control List*/
 enum SmartRobotCarMotionControl
@@ -78,12 +70,9 @@ enum SmartRobotCarFunctionalModel
   CMD_ClearAllFunctions_Standby_mode,     /*Clear All Functions And Enter Standby Mode*/
   CMD_ClearAllFunctions_Programming_mode, /*Clear All Functions And Enter Programming Mode*/
   CMD_MotorControl,                       /*Motor Control Mode*/
-  CMD_CarControl_TimeLimit,               /*Car Movement Direction Control With Time Limit*/
-  CMD_CarControl_NoTimeLimit,             /*Car Movement Direction Control Without Time Limit*/
-  CMD_MotorControl_Speed,                 /*Motor Speed Control*/
   CMD_ServoControl,                       /*Servo Motor Control*/
-  CMD_LightingControl_TimeLimit,          /*RGB Lighting Control With Time Limit*/
-  CMD_LightingControl_NoTimeLimit,        /*RGB Lighting Control Without Time Limit*/
+  CMD_Queue_mode,                         /*Queued Motion And Lighting Primitives*/
+  TrackingCalibration_mode,               /*Line Sensor Calibration Sweep*/
 
 };
 
@@ -92,19 +81,131 @@ struct Application_xxx
 {
   SmartRobotCarMotionControl Motion_Control;
   SmartRobotCarFunctionalModel Functional_Mode;
-  unsigned long CMD_CarControl_Millis;
-  unsigned long CMD_LightingControl_Millis;
 };
 Application_xxx Application_SmartRobotCarxxx0;
 
-bool ApplicationFunctionSet_SmartRobotCarLeaveTheGround(void);
-void ApplicationFunctionSet_SmartRobotCarLinearMotionControl(SmartRobotCarMotionControl direction, uint8_t directionRecord, uint8_t speed, uint8_t Kp, uint8_t UpperLimit);
-void ApplicationFunctionSet_SmartRobotCarMotionControl(SmartRobotCarMotionControl direction, uint8_t is_speed);
+/*
+  Serial transmit ring：output is queued here and moved into the core's interrupt driven 64-byte TX buffer only as far as
+  Serial.availableForWrite() allows, so a write never stalls the control loop.
+  Low priority output (diagnostics) is dropped when it would eat into the room kept for replies;
+  a reply only waits for the UART if even the whole ring cannot take it.
+*/
+#define SerialPortTx_Max 128    //Power of two
+#define SerialPortTx_Reserve 48 //Room kept for replies
+static uint8_t SerialPortTx_Buffer[SerialPortTx_Max];
+static uint8_t SerialPortTx_Head = 0;
+static uint8_t SerialPortTx_Tail = 0;
+static uint16_t SerialPortTx_Dropped = 0; //Low priority writes dropped
+static void SerialPortTx_Update(void)
+{
+  int room = Serial.availableForWrite();
+  while (room-- > 0 && SerialPortTx_Tail != SerialPortTx_Head)
+  {
+    Serial.write(SerialPortTx_Buffer[SerialPortTx_Tail]);
+    SerialPortTx_Tail = (SerialPortTx_Tail + 1) & (SerialPortTx_Max - 1);
+  }
+}
+static uint8_t SerialPortTx_Free(void)
+{
+  return (SerialPortTx_Tail - SerialPortTx_Head - 1) & (SerialPortTx_Max - 1);
+}
+static boolean SerialPortTx_Write(const uint8_t *p, uint8_t Length, boolean Priority)
+{
+  if (false == Priority && SerialPortTx_Free() < Length + SerialPortTx_Reserve)
+  {
+    SerialPortTx_Dropped++;
+    return false;
+  }
+  while (SerialPortTx_Free() < Length) //Reply larger than the room left：wait for the UART
+  {
+    SerialPortTx_Update();
+  }
+  while (Length--)
+  {
+    SerialPortTx_Buffer[SerialPortTx_Head] = *p++;
+    SerialPortTx_Head = (SerialPortTx_Head + 1) & (SerialPortTx_Max - 1);
+  }
+  SerialPortTx_Update();
+  return true;
+}
+static boolean SerialPortTx_Print(const char *Text, boolean Priority)
+{
+  return SerialPortTx_Write((const uint8_t *)Text, strlen(Text), Priority);
+}
+/*Everything queued is on the wire (before a baud rate change)*/
+static void SerialPortTx_Flush(void)
+{
+  while (SerialPortTx_Tail != SerialPortTx_Head)
+  {
+    SerialPortTx_Update();
+  }
+  Serial.flush();
+}
+void ApplicationFunctionSet::ApplicationFunctionSet_SerialPortPrint(const char *Text)
+{
+  SerialPortTx_Print(Text, false);
+}
+
+/*
+  Command response writer：replies are built in a fixed buffer and written in one go, no String temporaries.
+  {H_ok} / {H_true} / {H_false} / {H_123} / {H_v1_v2...}：CMD_ResponseBegin(H), CMD_ResponseText()/CMD_ResponseNumber() per value, CMD_ResponseEnd().
+  A reply that would not fit is cut short but always closed with '}'.
+*/
+#define CMD_Response_Max 48
+static char CMD_Response_Buffer[CMD_Response_Max];
+static uint8_t CMD_Response_Length = 0;
+static void CMD_ResponseAppend(const char *Text)
+{
+  while (*Text != '\0' && CMD_Response_Length < CMD_Response_Max - 1)
+  {
+    CMD_Response_Buffer[CMD_Response_Length++] = *Text++;
+  }
+}
+static void CMD_ResponseBegin(const char *H)
+{
+  CMD_Response_Length = 0;
+  CMD_ResponseAppend("{");
+  CMD_ResponseAppend(H);
+}
+static void CMD_ResponseText(const char *Text)
+{
+  CMD_ResponseAppend("_");
+  CMD_ResponseAppend(Text);
+}
+static void CMD_ResponseNumber(long Value)
+{
+  char toString[12];
+  ltoa(Value, toString, 10);
+  CMD_ResponseText(toString);
+}
+static void CMD_ResponseEnd(void)
+{
+  CMD_Response_Buffer[CMD_Response_Length++] = '}';
+  SerialPortTx_Write((const uint8_t *)CMD_Response_Buffer, CMD_Response_Length, true);
+}
+static void CMD_Response(const char *H, const char *Text)
+{
+  CMD_ResponseBegin(H);
+  CMD_ResponseText(Text);
+  CMD_ResponseEnd();
+}
+static void CMD_Response(const char *H, long Value)
+{
+  CMD_ResponseBegin(H);
+  CMD_ResponseNumber(Value);
+  CMD_ResponseEnd();
+}
+
+static bool ApplicationFunctionSet_SmartRobotCarLeaveTheGround(void);
+static void ApplicationFunctionSet_TrackingCalibrationLoad(void);
+static void ApplicationFunctionSet_TrackingCalibrationStart(const char *H);
+static void ApplicationFunctionSet_TrackingCalibrationClear(void);
+static void ApplicationFunctionSet_SmartRobotCarMotionControl(SmartRobotCarMotionControl direction, uint8_t is_speed);
 
 void ApplicationFunctionSet::ApplicationFunctionSet_Init(void)
 {
-  bool res_error = true;
   Serial.begin(9600);
+  AppADC.DeviceDriverSet_ADC_Init();
   AppVoltage.DeviceDriverSet_Voltage_Init();
   AppMotor.DeviceDriverSet_Motor_Init();
   AppServo.DeviceDriverSet_Servo_Init(90);
@@ -113,8 +214,8 @@ void ApplicationFunctionSet::ApplicationFunctionSet_Init(void)
   AppIRrecv.DeviceDriverSet_IRrecv_Init();
   AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Init();
   AppITR20001.DeviceDriverSet_ITR20001_Init();
-  res_error = AppMPU6050getdata.MPU6050_dveInit();
-  AppMPU6050getdata.MPU6050_calibration();
+  ApplicationFunctionSet_TrackingCalibrationLoad();
+  AppMPU6050getdata.MPU6050_dveInit(); //The gyro bias is estimated online once the car stands still
 
   // while (Serial.read() >= 0)
   // {
@@ -123,78 +224,306 @@ void ApplicationFunctionSet::ApplicationFunctionSet_Init(void)
   Application_SmartRobotCarxxx0.Functional_Mode = Standby_mode;
 }
 
-/*ITR20001 Check if the car leaves the ground*/
+/*
+  Lift detection：every LeaveTheGround_Period the evidence below is scored (capped at 100) and the confidence
+  moves half way towards it; the car counts as lifted from LeaveTheGround_On and back on the ground at LeaveTheGround_Off.
+  IR：all three sensors see nothing (> TrackingDetection_V)                                 +50
+  Lift：upward acceleration over LeaveTheGround_Rise for two periods while the IR goes blind +30
+  Tilt：Z under cos(35°) of the total (upright is +Z)：tilted more than ~35° or upside down   +80
+  Free fall：total acceleration under 0.5g                                                 +100
+  The IR alone cannot reach LeaveTheGround_On：a dark floor gives the IR score, and driving over bumps does not add to
+  it (a bump is a short jolt, up and down, and the IR went blind long before it). Picking the car up accelerates it
+  upwards for a while just as the IR goes blind, and holding it still afterwards stays inside the hysteresis band；
+  tipping over or falling lifts it whatever the IR sees.
+  Without the MPU6050 the IR alone decides. Costs one 6 byte I2C read per period; the IR values come from the
+  background ADC scan.
+*/
+#define LeaveTheGround_Period 50   //ms
+#define LeaveTheGround_On 70       //Confidence：lifted
+#define LeaveTheGround_Off 30      //Confidence：back on the ground
+#define LeaveTheGround_Rise 205    //1/1024 g：0.2g
+#define LeaveTheGround_LiftWindow 300 //ms：rise and IR going blind at most this far apart
 static bool ApplicationFunctionSet_SmartRobotCarLeaveTheGround(void)
 {
-  if (AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_R() > Application_FunctionSet.TrackingDetection_V &&
-      AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_M() > Application_FunctionSet.TrackingDetection_V &&
-      AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_L() > Application_FunctionSet.TrackingDetection_V)
+  static unsigned long LeaveTheGround_millis = 0;
+  static unsigned long LeaveTheGround_RiseMillis = 0;
+  static unsigned long LeaveTheGround_BlindMillis = 0;
+  static uint8_t LeaveTheGround_Rising = 0; //Periods in a row with upward acceleration
+  static bool LeaveTheGround_Risen = false;
+  static bool LeaveTheGround_Blind = true; //A car switched on over a dark floor has not just gone blind
+  if (millis() - LeaveTheGround_millis < LeaveTheGround_Period)
   {
-    Application_FunctionSet.Car_LeaveTheGround = false;
-    return false;
+    return Application_FunctionSet.Car_LeaveTheGround;
+  }
+  LeaveTheGround_millis = millis();
+
+  uint8_t score = 0;
+  int L, M, R;
+  AppITR20001.DeviceDriverSet_ITR20001_Get(&L, &M, &R);
+  bool ir = (R > Application_FunctionSet.TrackingDetection_V &&
+             M > Application_FunctionSet.TrackingDetection_V &&
+             L > Application_FunctionSet.TrackingDetection_V);
+  if (ir && false == LeaveTheGround_Blind)
+  {
+    LeaveTheGround_BlindMillis = millis();
+  }
+  LeaveTheGround_Blind = ir;
+  int16_t ax, ay, az;
+  if (AppMPU6050getdata.MPU6050_dveGetAcceleration(&ax, &ay, &az))
+  {
+    score = ir ? 100 : 0; //No accelerometer：IR only, as before
   }
   else
+  {
+    long x = ax >> 4, y = ay >> 4, z = az >> 4; //1/1024 g
+    long g2 = x * x + y * y + z * z;
+    LeaveTheGround_Rising = (z - 1024 > LeaveTheGround_Rise) ? min(LeaveTheGround_Rising + 1, 2) : 0;
+    if (LeaveTheGround_Rising >= 2)
+    {
+      LeaveTheGround_Risen = true;
+      LeaveTheGround_RiseMillis = millis();
+    }
+    if (ir)
+    {
+      score += 50;
+      if (LeaveTheGround_Risen && millis() - LeaveTheGround_BlindMillis <= LeaveTheGround_LiftWindow &&
+          millis() - LeaveTheGround_RiseMillis <= 2 * LeaveTheGround_LiftWindow) //Rise and blind IR together：picked up
+      {
+        score += 30;
+      }
+    }
+    if (z <= 0 || z * z * 3 < g2 * 2) //Upside down, or cos²(35°) ≈ 2/3 of the total
+    {
+      score += 80;
+    }
+    if (g2 < 512L * 512L)
+    {
+      score += 100;
+    }
+    if (score > 100)
+    {
+      score = 100;
+    }
+  }
+  uint8_t &confidence = Application_FunctionSet.Car_LeaveTheGround_Confidence;
+  confidence = (confidence + score + 1) / 2;
+  if (confidence >= LeaveTheGround_On)
+  {
+    Application_FunctionSet.Car_LeaveTheGround = false;
+  }
+  else if (confidence <= LeaveTheGround_Off)
   {
     Application_FunctionSet.Car_LeaveTheGround = true;
-    return true;
   }
+  return Application_FunctionSet.Car_LeaveTheGround;
 }
 /*
-  Straight line movement control：For dual-drive motors, due to frequent motor coefficient deviations and many external interference factors, 
-  it is difficult for the car to achieve relative Straight line movement. For this reason, the feedback of the yaw control loop is added.
-  direction：only forward/backward
-  directionRecord：Used to update the direction and position data (Yaw value) when entering the function for the first time.
-  speed：the speed range is 0~255
-  Kp：Position error proportional constant（The feedback of improving location resuming status，will be modified according to different mode），improve damping control.
-  UpperLimit：Maximum output upper limit control
+  Motor setpoint shaper：the modes set a target duty per wheel (ApplicationFunctionSet_SmartRobotCarMotorSetpoint) and
+  ApplicationFunctionSet_SmartRobotCarMotorShaper, run every MotorShaper_Period from the mode dispatch, moves the duty
+  actually driven towards it with the acceleration and jerk limits of the current mode. A step of the duty makes the
+  wheels slip (the gyro heading sees a turn that did not happen) and its current spike sags the battery.
+  Each wheel is a signed duty (+ direction_just, - direction_back) so a reversal ramps down through 0 and up again.
+  The acceleration is ramped down again early enough to arrive at the target without overshoot：a(a + J) / 2J is the
+  duty change still to come while it ramps down.
+  ApplicationFunctionSet_SmartRobotCarEmergencyStop bypasses the shaper (lifted car, clear all functions), and so does
+  ApplicationFunctionSet_SmartRobotCarMotionStep for the timed manoeuvres tuned on stepped duties (Obstacle back-off and turn).
 */
-static void ApplicationFunctionSet_SmartRobotCarLinearMotionControl(SmartRobotCarMotionControl direction, uint8_t directionRecord, uint8_t speed, uint8_t Kp, uint8_t UpperLimit)
+#define MotorShaper_Period 10 //ms
+#define MotorShaper_Accel(PWM_s) Q16_FromFloat((PWM_s) * MotorShaper_Period / 1000.0)                                //PWM/s -> PWM per period
+#define MotorShaper_Jerk(PWM_s2) Q16_FromFloat((PWM_s2) * MotorShaper_Period * MotorShaper_Period / 1000000.0) //PWM/s² -> PWM per period²
+struct MotorShaper_Limits
 {
-  static float Yaw; //Yaw
-  static float yaw_So = 0;
-  static uint8_t en = 110;
-  static unsigned long is_time;
-  if (en != directionRecord || millis() - is_time > 10)
+  q16_t Accel; //PWM per period
+  q16_t Jerk;  //PWM per period²
+};
+enum MotorShaper_LimitsIndex
+{
+  MotorShaper_Rocker,   //Hand driven：0~250 in about 0.25s
+  MotorShaper_Cruise,   //Autonomous and timed commands：gentle, the heading hold depends on the wheels not slipping
+  MotorShaper_Tracking, //Line tracking：the steering PID needs the wheel speeds it asks for within a few periods
+};
+static const MotorShaper_Limits MotorShaper_LimitsSet[] = {
+    /*MotorShaper_Rocker*/ {MotorShaper_Accel(1500), MotorShaper_Jerk(20000)},
+    /*MotorShaper_Cruise*/ {MotorShaper_Accel(800), MotorShaper_Jerk(8000)},
+    /*MotorShaper_Tracking*/ {MotorShaper_Accel(3000), MotorShaper_Jerk(60000)},
+};
+struct MotorShaper_Wheel
+{
+  q16_t Target; //Duty asked for by the mode
+  q16_t Duty;   //Duty driven
+  q16_t Accel;  //Duty change per period
+};
+static MotorShaper_Wheel MotorShaper[2]; //A...Right, B...Left
+/*Stop now：the shaper is bypassed and forgets the duty it was driving*/
+static void ApplicationFunctionSet_SmartRobotCarEmergencyStop(void)
+{
+  memset(MotorShaper, 0, sizeof(MotorShaper));
+  AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_void, /*speed_A*/ 0,
+                                         /*direction_B*/ direction_void, /*speed_B*/ 0, /*controlED*/ control_enable); //Motor control
+}
+static void ApplicationFunctionSet_SmartRobotCarMotorSetpoint(boolean direction_A, uint8_t speed_A, //Group A motor parameters
+                                                              boolean direction_B, uint8_t speed_B, //Group B motor parameters
+                                                              boolean controlED                     //AB enable setting (true)
+)
+{
+  if (controlED != control_enable) //Standby：not shaped
   {
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_void, /*speed_A*/ 0,
-                                           /*direction_B*/ direction_void, /*speed_B*/ 0, /*controlED*/ control_enable); //Motor control
-    AppMPU6050getdata.MPU6050_dveGetEulerAngles(&Yaw);
-    is_time = millis();
+    memset(MotorShaper, 0, sizeof(MotorShaper));
+    AppMotor.DeviceDriverSet_Motor_control(direction_void, 0, direction_void, 0, control_disable);
+    return;
   }
-  //if (en != directionRecord)
-  if (en != directionRecord || Application_FunctionSet.Car_LeaveTheGround == false)
+  MotorShaper[0].Target = Q16_FromInt((direction_A == direction_back) ? -speed_A : speed_A);
+  MotorShaper[1].Target = Q16_FromInt((direction_B == direction_back) ? -speed_B : speed_B);
+}
+static void ApplicationFunctionSet_SmartRobotCarMotorShape(MotorShaper_Wheel &Wheel, const MotorShaper_Limits &Limits)
+{
+  q16_t error = Q16_Sub(Wheel.Target, Wheel.Duty);
+  if (0 == error)
+  {
+    Wheel.Accel = 0;
+    return;
+  }
+  q16_t Accel = (error > 0) ? Limits.Accel : -Limits.Accel;
+  if ((Wheel.Accel > 0) == (error > 0)) //Accelerating towards the target：time to ramp the acceleration down？
+  {
+    q16_t brake = Q16_Add(Q16_Mul(Wheel.Accel, Wheel.Accel), Q16_Mul(abs(Wheel.Accel), Limits.Jerk));
+    if (Q16_Mul(abs(error), 2 * Limits.Jerk) <= brake)
+    {
+      Accel = 0;
+    }
+  }
+  Wheel.Accel = constrain(Accel, Wheel.Accel - Limits.Jerk, Wheel.Accel + Limits.Jerk);
+  Wheel.Duty = Q16_Add(Wheel.Duty, Wheel.Accel);
+  if ((error > 0) ? (Wheel.Duty >= Wheel.Target) : (Wheel.Duty <= Wheel.Target)) //Arrived
   {
-    en = directionRecord;
-    yaw_So = Yaw;
+    Wheel.Duty = Wheel.Target;
+    Wheel.Accel = 0;
   }
-  //Add proportional constant Kp to increase rebound effect
-  int R = (Yaw - yaw_So) * Kp + speed;
-  if (R > UpperLimit)
+}
+/*Drive the duty the shaper holds now*/
+static void ApplicationFunctionSet_SmartRobotCarMotorOutput(void)
+{
+  int16_t speed_A = Q16_ToInt(MotorShaper[0].Duty);
+  int16_t speed_B = Q16_ToInt(MotorShaper[1].Duty);
+  if (0 == speed_A && 0 == speed_B && 0 == MotorShaper[0].Target && 0 == MotorShaper[1].Target)
   {
-    R = UpperLimit;
+    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_void, /*speed_A*/ 0,
+                                           /*direction_B*/ direction_void, /*speed_B*/ 0, /*controlED*/ control_enable); //Motor control
+    return;
   }
-  else if (R < 10)
+  AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ (speed_A >= 0) ? direction_just : direction_back, /*speed_A*/ abs(speed_A),
+                                         /*direction_B*/ (speed_B >= 0) ? direction_just : direction_back, /*speed_B*/ abs(speed_B), /*controlED*/ control_enable); //Motor control
+}
+static void ApplicationFunctionSet_SmartRobotCarMotorShaper(void)
+{
+  static unsigned long MotorShaper_millis = 0;
+  if (millis() - MotorShaper_millis < MotorShaper_Period)
   {
-    R = 10;
+    return;
   }
-  int L = (yaw_So - Yaw) * Kp + speed;
-  if (L > UpperLimit)
+  MotorShaper_millis = millis();
+  const MotorShaper_Limits *Limits;
+  switch (Application_SmartRobotCarxxx0.Functional_Mode)
   {
-    L = UpperLimit;
+  case TraceBased_mode:
+  case TrackingCalibration_mode:
+    Limits = &MotorShaper_LimitsSet[MotorShaper_Tracking];
+    break;
+  case ObstacleAvoidance_mode:
+  case Follow_mode:
+  case CMD_Queue_mode:
+    Limits = &MotorShaper_LimitsSet[MotorShaper_Cruise];
+    break;
+  default: //Rocker_mode and the rest
+    Limits = &MotorShaper_LimitsSet[MotorShaper_Rocker];
+    break;
   }
-  else if (L < 10)
+  ApplicationFunctionSet_SmartRobotCarMotorShape(MotorShaper[0], *Limits);
+  ApplicationFunctionSet_SmartRobotCarMotorShape(MotorShaper[1], *Limits);
+  ApplicationFunctionSet_SmartRobotCarMotorOutput();
+}
+/*
+  Straight line movement control：For dual-drive motors, due to frequent motor coefficient deviations and many external interference factors, 
+  it is difficult for the car to achieve relative Straight line movement. For this reason, the feedback of the yaw control loop is added.
+  The heading hold is a PID on the yaw error run every HeadingHold_Period (the gyro FIFO rate), the motors keep the last output in between
+  and are never stopped to read the gyro. The integral is only accumulated while neither side is saturated in the direction it would push
+  (anti-windup) and is bounded to the UpperLimit of the gain set；the derivative acts on the measured yaw rate.
+  All of it runs in Q16.16 fixed point (FixedPoint_Q16.h), the gains are folded to q16_t at compile time.
+  direction：only forward/backward
+  directionRecord：Used to update the direction and position data (Yaw value) when entering the function for the first time.
+  speed：the speed range is 0~255
+  Gains：gain set of the calling mode (HeadingHold_GainSet)
+*/
+#define HeadingHold_Period 10 //ms
+#define HeadingHold_Min 10    //Lowest PWM on the slower side
+struct HeadingHold_Gains
+{
+  q16_t Kp;           //PWM per degree
+  q16_t Ki;           //PWM per degree·s
+  q16_t Kd;           //PWM per degree/s
+  q16_t IntegralMax;  //degree·s：UpperLimit / Ki
+  uint8_t UpperLimit; //Maximum output upper limit control
+};
+enum HeadingHold_GainSetIndex
+{
+  HeadingHold_Rocker, //Hand driven：stiff correction, full speed
+  HeadingHold_Cruise, //Autonomous and timed commands：soft correction, capped speed
+};
+static const HeadingHold_Gains HeadingHold_GainSet[] = {
+    /*HeadingHold_Rocker*/ {Q16_FromFloat(10.0), Q16_FromFloat(20.0), Q16_FromFloat(0.3), Q16_FromFloat(255 / 20.0), 255},
+    /*HeadingHold_Cruise*/ {Q16_FromFloat(2.0), Q16_FromFloat(4.0), Q16_FromFloat(0.1), Q16_FromFloat(180 / 4.0), 180},
+};
+/*PID output (PWM, ±512) from the yaw error, the integral and the yaw change over dt (ms)*/
+static int ApplicationFunctionSet_HeadingHoldCorrection(const HeadingHold_Gains &Gains, q16_t error, q16_t Integral, q16_t dYaw, unsigned long dt)
+{
+  q16_t rate = Q16_DivInt(Q16_MulInt(dYaw, 1000), dt); //degree/s
+  q16_t Output = Q16_Add(Q16_Add(Q16_Mul(Gains.Kp, error), Q16_Mul(Gains.Ki, Integral)), Q16_Mul(Gains.Kd, rate));
+  return Q16_ToInt(constrain(Output, -Q16_FromInt(512), Q16_FromInt(512)));
+}
+static void ApplicationFunctionSet_SmartRobotCarLinearMotionControl(SmartRobotCarMotionControl direction, uint8_t directionRecord, uint8_t speed, const HeadingHold_Gains &Gains)
+{
+  static q16_t Yaw; //Yaw
+  static q16_t Yaw_last;
+  static q16_t yaw_So = 0;
+  static q16_t Integral = 0;
+  static uint8_t en = 110;
+  static unsigned long is_time;
+  static int R, L;
+  if (en != directionRecord || millis() - is_time >= HeadingHold_Period)
   {
-    L = 10;
+    AppMPU6050getdata.MPU6050_dveGetEulerAngles(&Yaw);
+    unsigned long dt = millis() - is_time; //ms
+    is_time = millis();
+    if (en != directionRecord || Application_FunctionSet.Car_LeaveTheGround == false || dt > 100)
+    { //New heading (or lifted, or the loop was not running)：hold the current yaw from here
+      en = directionRecord;
+      yaw_So = Yaw;
+      Yaw_last = Yaw;
+      Integral = 0;
+      dt = HeadingHold_Period;
+    }
+    q16_t error = Q16_Sub(Yaw, yaw_So);
+    int correction = ApplicationFunctionSet_HeadingHoldCorrection(Gains, error, Integral, Q16_Sub(Yaw, Yaw_last), dt);
+    Yaw_last = Yaw;
+    R = speed + correction;
+    L = speed - correction;
+    bool saturated = (error > 0) ? (R >= Gains.UpperLimit || L <= HeadingHold_Min) : (R <= HeadingHold_Min || L >= Gains.UpperLimit);
+    if (false == saturated)
+    {
+      Integral = constrain(Q16_Add(Integral, Q16_Mul(error, Q16_FromRatio(dt, 1000))), -Gains.IntegralMax, Gains.IntegralMax);
+    }
+    R = constrain(R, HeadingHold_Min, Gains.UpperLimit);
+    L = constrain(L, HeadingHold_Min, Gains.UpperLimit);
   }
   if (direction == Forward) //Forward
   {
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ R,
-                                           /*direction_B*/ direction_just, /*speed_B*/ L, /*controlED*/ control_enable);
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ R,
+                                                      /*direction_B*/ direction_just, /*speed_B*/ L, /*controlED*/ control_enable);
   }
   else if (direction == Backward) //Backward
   {
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ L,
-                                           /*direction_B*/ direction_back, /*speed_B*/ R, /*controlED*/ control_enable);
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_back, /*speed_A*/ L,
+                                                      /*direction_B*/ direction_back, /*speed_B*/ R, /*controlED*/ control_enable);
   }
 }
 /*
@@ -206,35 +535,19 @@ static void ApplicationFunctionSet_SmartRobotCarMotionControl(SmartRobotCarMotio
 {
   ApplicationFunctionSet Application_FunctionSet;
   static uint8_t directionRecord = 0;
-  uint8_t Kp, UpperLimit;
   uint8_t speed = is_speed;
   //Control mode that requires straight line movement adjustment（Car will has movement offset easily in the below mode，the movement cannot achieve the effect of a relatively straight direction
   //so it needs to add control adjustment）
+  const HeadingHold_Gains *Gains;
   switch (Application_SmartRobotCarxxx0.Functional_Mode)
   {
-  case Rocker_mode:
-    Kp = 10;
-    UpperLimit = 255;
-    break;
   case ObstacleAvoidance_mode:
-    Kp = 2;
-    UpperLimit = 180;
-    break;
   case Follow_mode:
-    Kp = 2;
-    UpperLimit = 180;
-    break;
-  case CMD_CarControl_TimeLimit:
-    Kp = 2;
-    UpperLimit = 180;
+  case CMD_Queue_mode:
+    Gains = &HeadingHold_GainSet[HeadingHold_Cruise];
     break;
-  case CMD_CarControl_NoTimeLimit:
-    Kp = 2;
-    UpperLimit = 180;
-    break;
-  default:
-    Kp = 10;
-    UpperLimit = 255;
+  default: //Rocker_mode and the rest
+    Gains = &HeadingHold_GainSet[HeadingHold_Rocker];
     break;
   }
   switch (direction)
@@ -244,12 +557,12 @@ static void ApplicationFunctionSet_SmartRobotCarMotionControl(SmartRobotCarMotio
     /* code */
     if (Application_SmartRobotCarxxx0.Functional_Mode == TraceBased_mode)
     {
-      AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ speed,
-                                             /*direction_B*/ direction_just, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
+      ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ speed,
+                                                        /*direction_B*/ direction_just, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
     }
     else
     { //When moving forward, enter the direction and position approach control loop processing
-      ApplicationFunctionSet_SmartRobotCarLinearMotionControl(Forward, directionRecord, speed, Kp, UpperLimit);
+      ApplicationFunctionSet_SmartRobotCarLinearMotionControl(Forward, directionRecord, speed, *Gains);
       directionRecord = 1;
     }
 
@@ -258,12 +571,12 @@ static void ApplicationFunctionSet_SmartRobotCarMotionControl(SmartRobotCarMotio
     /* code */
     if (Application_SmartRobotCarxxx0.Functional_Mode == TraceBased_mode)
     {
-      AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ speed,
-                                             /*direction_B*/ direction_back, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
+      ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_back, /*speed_A*/ speed,
+                                                        /*direction_B*/ direction_back, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
     }
     else
     { //When moving backward, enter the direction and position approach control loop processing
-      ApplicationFunctionSet_SmartRobotCarLinearMotionControl(Backward, directionRecord, speed, Kp, UpperLimit);
+      ApplicationFunctionSet_SmartRobotCarLinearMotionControl(Backward, directionRecord, speed, *Gains);
       directionRecord = 2;
     }
 
@@ -271,44 +584,44 @@ static void ApplicationFunctionSet_SmartRobotCarMotionControl(SmartRobotCarMotio
   case /* constant-expression */ Left:
     /* code */
     directionRecord = 3;
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ speed,
-                                           /*direction_B*/ direction_back, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ speed,
+                                                      /*direction_B*/ direction_back, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
     break;
   case /* constant-expression */ Right:
     /* code */
     directionRecord = 4;
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ speed,
-                                           /*direction_B*/ direction_just, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_back, /*speed_A*/ speed,
+                                                      /*direction_B*/ direction_just, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
     break;
   case /* constant-expression */ LeftForward:
     /* code */
     directionRecord = 5;
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ speed,
-                                           /*direction_B*/ direction_just, /*speed_B*/ speed / 2, /*controlED*/ control_enable); //Motor control
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ speed,
+                                                      /*direction_B*/ direction_just, /*speed_B*/ speed / 2, /*controlED*/ control_enable); //Motor control
     break;
   case /* constant-expression */ LeftBackward:
     /* code */
     directionRecord = 6;
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ speed,
-                                           /*direction_B*/ direction_back, /*speed_B*/ speed / 2, /*controlED*/ control_enable); //Motor control
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_back, /*speed_A*/ speed,
+                                                      /*direction_B*/ direction_back, /*speed_B*/ speed / 2, /*controlED*/ control_enable); //Motor control
     break;
   case /* constant-expression */ RightForward:
     /* code */
     directionRecord = 7;
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ speed / 2,
-                                           /*direction_B*/ direction_just, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ speed / 2,
+                                                      /*direction_B*/ direction_just, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
     break;
   case /* constant-expression */ RightBackward:
     /* code */
     directionRecord = 8;
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ speed / 2,
-                                           /*direction_B*/ direction_back, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_back, /*speed_A*/ speed / 2,
+                                                      /*direction_B*/ direction_back, /*speed_B*/ speed, /*controlED*/ control_enable); //Motor control
     break;
   case /* constant-expression */ stop_it:
     /* code */
     directionRecord = 9;
-    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_void, /*speed_A*/ 0,
-                                           /*direction_B*/ direction_void, /*speed_B*/ 0, /*controlED*/ control_enable); //Motor control
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_void, /*speed_A*/ 0,
+                                                      /*direction_B*/ direction_void, /*speed_B*/ 0, /*controlED*/ control_enable); //Motor control
 
     break;
   default:
@@ -316,9 +629,21 @@ static void ApplicationFunctionSet_SmartRobotCarMotionControl(SmartRobotCarMotio
     break;
   }
 }
+/*Motion control without the shaper：the duty steps to the setpoint now*/
+static void ApplicationFunctionSet_SmartRobotCarMotionStep(SmartRobotCarMotionControl direction, uint8_t is_speed)
+{
+  ApplicationFunctionSet_SmartRobotCarMotionControl(direction, is_speed);
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    MotorShaper[i].Duty = MotorShaper[i].Target;
+    MotorShaper[i].Accel = 0;
+  }
+  ApplicationFunctionSet_SmartRobotCarMotorOutput();
+}
 /*
  Robot car update sensors' data:Partial update (selective update)
 */
+#define MPU6050_StillSettle 300 //ms after the last motor drive before the car counts as at rest
 void ApplicationFunctionSet::ApplicationFunctionSet_SensorDataUpdate(void)
 {
 
@@ -346,19 +671,37 @@ void ApplicationFunctionSet::ApplicationFunctionSet_SensorDataUpdate(void)
     }
   }
 
-  // { /*value updation for the ultrasonic sensor：for the Obstacle Avoidance mode*/
-  //   AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(&UltrasoundData_cm /*out*/);
-  //   UltrasoundDetectionStatus = function_xxx(UltrasoundData_cm, 0, ObstacleDetection);
-  // }
+  { /*value updation for the ultrasonic sensor：non-blocking ping, the latest distance is cached in the driver*/
+    AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Update();
+  }
+
+  { /*servo moves：mark a servo in position once its estimated slew time has passed*/
+    AppServo.DeviceDriverSet_Servo_Update();
+  }
 
-  { /*value updation for the IR sensors on the line tracking module：for the line tracking mode*/
-    TrackingData_R = AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_R();
-    TrackingDetectionStatus_R = function_xxx(TrackingData_R, TrackingDetection_S, TrackingDetection_E);
-    TrackingData_M = AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_M();
-    TrackingDetectionStatus_M = function_xxx(TrackingData_M, TrackingDetection_S, TrackingDetection_E);
-    TrackingData_L = AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_L();
-    TrackingDetectionStatus_L = function_xxx(TrackingData_L, TrackingDetection_S, TrackingDetection_E);
-    //ITR20001 Check if the car leaves the ground
+  { /*value updation for the IR sensors on the line tracking module：for the line tracking mode (only when the ADC scan has new data)*/
+    static uint16_t Tracking_Sequence = 0;
+    int L, M, R;
+    uint16_t sequence = AppITR20001.DeviceDriverSet_ITR20001_Get(&L, &M, &R);
+    if (sequence != Tracking_Sequence)
+    {
+      Tracking_Sequence = sequence;
+      TrackingData_R = R;
+      TrackingDetectionStatus_R = function_xxx(TrackingData_R, TrackingDetection_S[2], TrackingDetection_E[2]);
+      TrackingData_M = M;
+      TrackingDetectionStatus_M = function_xxx(TrackingData_M, TrackingDetection_S[1], TrackingDetection_E[1]);
+      TrackingData_L = L;
+      TrackingDetectionStatus_L = function_xxx(TrackingData_L, TrackingDetection_S[0], TrackingDetection_E[0]);
+    }
+  }
+
+  { /*gyro FIFO：pick up the last queued I2C read and queue the next one (never waits for the bus)；
+      the bias estimator only trusts still windows once the motors have been off for MPU6050_StillSettle*/
+    AppMPU6050getdata.Motor_Stopped = (millis() - AppMotor.Motor_RunMillis > MPU6050_StillSettle);
+    AppMPU6050getdata.MPU6050_dveUpdate();
+  }
+
+  { /*lift detection：accelerometer and IR, runs at its own period*/
     ApplicationFunctionSet_SmartRobotCarLeaveTheGround();
   }
 
@@ -547,272 +890,364 @@ void ApplicationFunctionSet::ApplicationFunctionSet_RGB(void)
 /*Rocker control mode*/
 void ApplicationFunctionSet::ApplicationFunctionSet_Rocker(void)
 {
-  if (Application_SmartRobotCarxxx0.Functional_Mode == Rocker_mode)
-  {
-    ApplicationFunctionSet_SmartRobotCarMotionControl(Application_SmartRobotCarxxx0.Motion_Control /*direction*/, Rocker_CarSpeed /*speed*/);
-  }
+  ApplicationFunctionSet_SmartRobotCarMotionControl(Application_SmartRobotCarxxx0.Motion_Control /*direction*/, Rocker_CarSpeed /*speed*/);
 }
 
-/*Line tracking mode*/
+/*
+  Line tracking mode：line position from the weighted centroid of the three analog readings, PID steering.
+  Each reading is weighted by how far it is into its own TrackingDetection_S~TrackingDetection_E window (0~1000), and
+  position = 1000 * (R - L) / (L + M + R)：-1000 line under the left sensor, 0 centred, +1000 under the right one.
+  Every Tracking_Period the PID turns the position error into a wheel speed difference,
+  turn = (Kp * e + Ki * sum(e) / 100 + Kd * de) / 1000, and the forward speed drops from Tracking_Speed towards
+  Tracking_Speed_Min with the error and its rate of change (curvature). Gains：N 27.
+  With the line lost the car stops and sweeps for it, towards the side it was last seen first.
+*/
+#define Tracking_Period 10         //ms
+#define Tracking_LineMin 150       //Weight sum below this：no line under the sensors
+#define Tracking_IntegralMax 20000 //Anti-windup clamp of sum(e)
+#define Tracking_Speed_Min 60
+static int16_t Tracking_Kp = 100; //Defaults from tests/host/sim_Tracking.cpp
+static int16_t Tracking_Ki = 0;
+static int16_t Tracking_Kd = 300;
+static uint8_t Tracking_Speed = 150;
+static int16_t Tracking_Error = 0;
+static int32_t Tracking_Integral = 0;
+static unsigned long Tracking_millis = 0;
+static boolean Tracking_timestamp = true;
+static boolean Tracking_BlindDetection = true;
+static unsigned long Tracking_MotorRL_time = 0;
+/*Reading normalized to its sensor's line window：0 at S, 1000 at E*/
+static int16_t ApplicationFunctionSet_TrackingWeight(int Data, uint16_t S, uint16_t E)
+{
+  return (int32_t)constrain(Data - (int)S, 0, (int)(E - S)) * 1000 / (E - S);
+}
 void ApplicationFunctionSet::ApplicationFunctionSet_Tracking(void)
 {
-  static boolean timestamp = true;
-  static boolean BlindDetection = true;
-  static unsigned long MotorRL_time = 0;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == TraceBased_mode)
+  if (Car_LeaveTheGround == false) //Check if the car leaves the ground
   {
-    if (Car_LeaveTheGround == false) //Check if the car leaves the ground
-    {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-      return;
-    }
+    ApplicationFunctionSet_SmartRobotCarEmergencyStop();
+    return;
+  }
+  if (millis() - Tracking_millis < Tracking_Period)
+  {
+    return;
+  }
+  Tracking_millis = millis();
 
-    // int getAnaloguexxx_L = AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_L();
-    // int getAnaloguexxx_M = AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_M();
-    // int getAnaloguexxx_R = AppITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_R();
 #if _Test_print
-    static unsigned long print_time = 0;
-    if (millis() - print_time > 500)
-    {
-      print_time = millis();
-      Serial.print("ITR20001_getAnaloguexxx_L=");
-      Serial.println(getAnaloguexxx_L);
-      Serial.print("ITR20001_getAnaloguexxx_M=");
-      Serial.println(getAnaloguexxx_M);
-      Serial.print("ITR20001_getAnaloguexxx_R=");
-      Serial.println(getAnaloguexxx_R);
-    }
+  static unsigned long print_time = 0;
+  if (millis() - print_time > 500)
+  {
+    print_time = millis();
+    Serial.print("ITR20001_getAnaloguexxx_L=");
+    Serial.println(TrackingData_L);
+    Serial.print("ITR20001_getAnaloguexxx_M=");
+    Serial.println(TrackingData_M);
+    Serial.print("ITR20001_getAnaloguexxx_R=");
+    Serial.println(TrackingData_R);
+  }
 #endif
-    if (function_xxx(TrackingData_M, TrackingDetection_S, TrackingDetection_E))
-    {
-      /*Achieve straight and uniform speed movement*/
-      ApplicationFunctionSet_SmartRobotCarMotionControl(Forward, 100);
-      timestamp = true;
-      BlindDetection = true;
+  int16_t weight_L = ApplicationFunctionSet_TrackingWeight(TrackingData_L, TrackingDetection_S[0], TrackingDetection_E[0]);
+  int16_t weight_M = ApplicationFunctionSet_TrackingWeight(TrackingData_M, TrackingDetection_S[1], TrackingDetection_E[1]);
+  int16_t weight_R = ApplicationFunctionSet_TrackingWeight(TrackingData_R, TrackingDetection_S[2], TrackingDetection_E[2]);
+  int16_t weight = weight_L + weight_M + weight_R;
+  if (weight >= Tracking_LineMin)
+  {
+    int16_t error = (int32_t)(weight_R - weight_L) * 1000 / weight;
+    int16_t derivative = error - Tracking_Error;
+    Tracking_Error = error;
+    Tracking_Integral = constrain(Tracking_Integral + error, -Tracking_IntegralMax, Tracking_IntegralMax);
+    int32_t turn = ((int32_t)Tracking_Kp * error + (int32_t)Tracking_Ki * Tracking_Integral / 100 + (int32_t)Tracking_Kd * derivative) / 1000;
+
+    /*Slow down for a large error and for a fast changing one (curve)*/
+    int16_t slowdown = min(1000, abs(error) + 4 * abs(derivative));
+    int16_t speed = Tracking_Speed - (int32_t)(Tracking_Speed - Tracking_Speed_Min) * slowdown / 1000;
+    int16_t speed_R = constrain(speed - turn, -255, 255);
+    int16_t speed_L = constrain(speed + turn, -255, 255);
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ (speed_R >= 0) ? direction_just : direction_back, /*speed_A*/ abs(speed_R),
+                                                      /*direction_B*/ (speed_L >= 0) ? direction_just : direction_back, /*speed_B*/ abs(speed_L), /*controlED*/ control_enable); //Motor control
+    Tracking_timestamp = true;
+    Tracking_BlindDetection = true;
+  }
+  else ////The car is not on the black line. execute Blind scan
+  {
+    SmartRobotCarMotionControl first = (Tracking_Error < 0) ? Left : Right;
+    SmartRobotCarMotionControl second = (Tracking_Error < 0) ? Right : Left;
+    if (Tracking_timestamp == true) //acquire timestamp
+    {
+      Tracking_timestamp = false;
+      Tracking_Integral = 0;
+      Tracking_MotorRL_time = millis();
+      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
     }
-    else if (function_xxx(TrackingData_R, TrackingDetection_S, TrackingDetection_E))
+    /*Blind Detection*/
+    if ((function_xxx((millis() - Tracking_MotorRL_time), 0, 200) || function_xxx((millis() - Tracking_MotorRL_time), 1600, 2000)) && Tracking_BlindDetection == true)
     {
-      /*Turn right*/
-      ApplicationFunctionSet_SmartRobotCarMotionControl(Right, 100);
-      timestamp = true;
-      BlindDetection = true;
+      ApplicationFunctionSet_SmartRobotCarMotionControl(first, 100);
     }
-    else if (function_xxx(TrackingData_L, TrackingDetection_S, TrackingDetection_E))
+    else if (((function_xxx((millis() - Tracking_MotorRL_time), 200, 1600))) && Tracking_BlindDetection == true)
     {
-      /*Turn left*/
-      ApplicationFunctionSet_SmartRobotCarMotionControl(Left, 100);
-      timestamp = true;
-      BlindDetection = true;
+      ApplicationFunctionSet_SmartRobotCarMotionControl(second, 100);
     }
-    else ////The car is not on the black line. execute Blind scan
+    else if ((function_xxx((millis() - Tracking_MotorRL_time), 3000, 3500))) // Blind Detection ...s ?
     {
-      if (timestamp == true) //acquire timestamp
-      {
-        timestamp = false;
-        MotorRL_time = millis();
-        ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-      }
-      /*Blind Detection*/
-      if ((function_xxx((millis() - MotorRL_time), 0, 200) || function_xxx((millis() - MotorRL_time), 1600, 2000)) && BlindDetection == true)
-      {
-        ApplicationFunctionSet_SmartRobotCarMotionControl(Right, 100);
-      }
-      else if (((function_xxx((millis() - MotorRL_time), 200, 1600))) && BlindDetection == true)
-      {
-        ApplicationFunctionSet_SmartRobotCarMotionControl(Left, 100);
-      }
-      else if ((function_xxx((millis() - MotorRL_time), 3000, 3500))) // Blind Detection ...s ?
-      {
-        BlindDetection = false;
-        ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-      }
+      Tracking_BlindDetection = false;
+      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
     }
   }
-  else if (false == timestamp)
-  {
-    BlindDetection = true;
-    timestamp = true;
-    MotorRL_time = 0;
-  }
 }
 
 /*
-  Obstacle Avoidance Mode
+  Obstacle Avoidance Mode：a state machine advanced once per loop, so serial, IR and lift detection stay live.
+  Cruise -> Stop -> ScanRight(30) -> ScanCentre(90) -> ScanLeft(150) -> Choose -> [BackOff] -> Turn -> Cruise
+  Choose turns towards the first clear direction in scan order, scanning on while none is clear;
+  when all three are blocked it backs off and turns right.
+  Back-off and turn are timed, so they step the duty past the shaper (ApplicationFunctionSet_SmartRobotCarMotionStep)
+  and the turn ends stepping to Forward as the blocking version did：the angles stay those it was tuned for.
 */
+enum ObstacleAvoidanceState
+{
+  Obstacle_Cruise,     /*Drive forward while the way ahead is clear*/
+  Obstacle_Stop,       /*Obstacle ahead：stop*/
+  Obstacle_ScanRight,  /*Servo to 30 degrees and measure*/
+  Obstacle_ScanCentre, /*Servo to 90 degrees and measure*/
+  Obstacle_ScanLeft,   /*Servo to 150 degrees and measure*/
+  Obstacle_Choose,     /*Pick the first clear direction*/
+  Obstacle_BackOff,    /*All directions blocked：reverse*/
+  Obstacle_Turn,       /*Move towards the chosen direction for Obstacle_Turn_Time, the servo returns to 90 degrees meanwhile*/
+};
+#define Obstacle_Scan_Timeout 1000 //ms：servo move plus one ping
+#define Obstacle_BackOff_Time 500  //ms
+#define Obstacle_Turn_Time 500     //ms：the 50ms turn plus the blocking 450ms servo return it used to last
+#define Obstacle_Speed 150
+static ObstacleAvoidanceState Obstacle_State = Obstacle_Cruise;
+static unsigned long Obstacle_State_millis = 0;
+static uint8_t Obstacle_Scan_Number = 0;                   //Number of directions scanned
+static boolean Obstacle_Scan_Clear[3];                     //Right, centre, left
+static SmartRobotCarMotionControl Obstacle_Turn_Direction; //Chosen direction
+static boolean Obstacle_Settled = false;
+static unsigned long Obstacle_Settle_millis = 0;
+
+static void ApplicationFunctionSet_ObstacleState(ObstacleAvoidanceState State)
+{
+  const uint8_t Scan_angle[3] = {30, 90, 150};
+  Obstacle_State = State;
+  Obstacle_State_millis = millis();
+  switch (State)
+  {
+  case Obstacle_Cruise:
+    AppServo.DeviceDriverSet_Servo_control(90 /*Position_angle*/);
+    break;
+  case Obstacle_Stop:
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+    Obstacle_Scan_Number = 0;
+    break;
+  case Obstacle_ScanRight:
+  case Obstacle_ScanCentre:
+  case Obstacle_ScanLeft:
+    AppServo.DeviceDriverSet_Servo_control(Scan_angle[State - Obstacle_ScanRight] /*Position_angle*/);
+    break;
+  case Obstacle_BackOff:
+    ApplicationFunctionSet_SmartRobotCarMotionStep(Backward, Obstacle_Speed);
+    break;
+  case Obstacle_Turn:
+    ApplicationFunctionSet_SmartRobotCarMotionStep(Obstacle_Turn_Direction, Obstacle_Speed);
+    AppServo.DeviceDriverSet_Servo_control(90 /*Position_angle*/);
+    break;
+  default:
+    break;
+  }
+}
+//Distance measured after the ultrasonic servo came to rest：false while the servo turns or the latest ping is older
+static boolean ApplicationFunctionSet_ObstacleDistance(uint16_t *get_Distance /*out*/)
+{
+  unsigned long Distance_millis;
+  if (false == AppServo.DeviceDriverSet_Servo_InPosition(1))
+  {
+    Obstacle_Settled = false;
+    return false;
+  }
+  if (false == Obstacle_Settled)
+  {
+    Obstacle_Settled = true;
+    Obstacle_Settle_millis = millis();
+  }
+  AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(get_Distance /*out*/, &Distance_millis /*out*/);
+  return (long)(Distance_millis - Obstacle_Settle_millis) >= 0;
+}
 void ApplicationFunctionSet::ApplicationFunctionSet_Obstacle(void)
 {
-  static boolean first_is = true;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == ObstacleAvoidance_mode)
+  uint16_t get_Distance;
+  if (Car_LeaveTheGround == false)
+  {
+    ApplicationFunctionSet_SmartRobotCarEmergencyStop();
+    ApplicationFunctionSet_ObstacleState(Obstacle_Cruise);
+    return;
+  }
+  switch (Obstacle_State)
   {
-    uint8_t switc_ctrl = 0;
-    uint16_t get_Distance;
-    if (Car_LeaveTheGround == false)
+  case Obstacle_Cruise:
+    if (ApplicationFunctionSet_ObstacleDistance(&get_Distance /*out*/))
     {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-      return;
+      if (function_xxx(get_Distance, 0, 20))
+      {
+        ApplicationFunctionSet_ObstacleState(Obstacle_Stop);
+      }
+      else
+      {
+        ApplicationFunctionSet_SmartRobotCarMotionControl(Forward, Obstacle_Speed);
+      }
     }
-    if (first_is == true) //Enter the mode for the first time, and modulate the steering gear to 90 degrees
+    break;
+  case Obstacle_Stop:
+    ApplicationFunctionSet_ObstacleState(Obstacle_ScanRight);
+    break;
+  case Obstacle_ScanRight:
+  case Obstacle_ScanCentre:
+  case Obstacle_ScanLeft:
+    if (ApplicationFunctionSet_ObstacleDistance(&get_Distance /*out*/) || (millis() - Obstacle_State_millis) > Obstacle_Scan_Timeout)
     {
-      AppServo.DeviceDriverSet_Servo_control(90 /*Position_angle*/);
-      first_is = false;
+      if (false == AppServo.DeviceDriverSet_Servo_InPosition(1)) //Timed out：use the latest distance
+      {
+        AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(&get_Distance /*out*/);
+      }
+      Obstacle_Scan_Clear[Obstacle_Scan_Number++] = !function_xxx(get_Distance, 0, 20);
+      ApplicationFunctionSet_ObstacleState(Obstacle_Choose);
     }
-
-    AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(&get_Distance /*out*/);
-    if (function_xxx(get_Distance, 0, 20))
+    break;
+  case Obstacle_Choose:
+  {
+    const SmartRobotCarMotionControl Scan_Direction[3] = {Right, Forward, Left};
+    for (uint8_t i = 0; i < Obstacle_Scan_Number; i++)
     {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-
-      for (uint8_t i = 1; i < 6; i += 2) //1、3、5 Omnidirectional detection of obstacle avoidance status
+      if (Obstacle_Scan_Clear[i])
       {
-        AppServo.DeviceDriverSet_Servo_control(30 * i /*Position_angle*/);
-        delay_xxx(1);
-        AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(&get_Distance /*out*/);
-
-        if (function_xxx(get_Distance, 0, 20))
-        {
-          ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-          if (5 == i)
-          {
-            ApplicationFunctionSet_SmartRobotCarMotionControl(Backward, 150);
-            delay_xxx(500);
-            ApplicationFunctionSet_SmartRobotCarMotionControl(Right, 150);
-            delay_xxx(50);
-            first_is = true;
-            break;
-          }
-        }
-        else
-        {
-          switc_ctrl = 0;
-          switch (i)
-          {
-          case 1:
-            ApplicationFunctionSet_SmartRobotCarMotionControl(Right, 150);
-            break;
-          case 3:
-            ApplicationFunctionSet_SmartRobotCarMotionControl(Forward, 150);
-            break;
-          case 5:
-            ApplicationFunctionSet_SmartRobotCarMotionControl(Left, 150);
-            break;
-          }
-          delay_xxx(50);
-          first_is = true;
-          break;
-        }
+        Obstacle_Turn_Direction = Scan_Direction[i];
+        ApplicationFunctionSet_ObstacleState(Obstacle_Turn);
+        return;
       }
     }
-    else //if (function_xxx(get_Distance, 20, 50))
+    if (Obstacle_Scan_Number < 3)
+    {
+      ApplicationFunctionSet_ObstacleState((ObstacleAvoidanceState)(Obstacle_ScanRight + Obstacle_Scan_Number));
+    }
+    else
     {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(Forward, 150);
+      ApplicationFunctionSet_ObstacleState(Obstacle_BackOff);
     }
   }
-  else
-  {
-    first_is = true;
+  break;
+  case Obstacle_BackOff:
+    if ((millis() - Obstacle_State_millis) > Obstacle_BackOff_Time)
+    {
+      Obstacle_Turn_Direction = Right;
+      ApplicationFunctionSet_ObstacleState(Obstacle_Turn);
+    }
+    break;
+  case Obstacle_Turn:
+    if ((millis() - Obstacle_State_millis) > Obstacle_Turn_Time)
+    {
+      ApplicationFunctionSet_SmartRobotCarMotionStep(Forward, Obstacle_Speed);
+      ApplicationFunctionSet_ObstacleState(Obstacle_Cruise);
+    }
+    break;
+  default:
+    ApplicationFunctionSet_ObstacleState(Obstacle_Cruise);
+    break;
   }
 }
 
 /*
   Following mode：
 */
+static uint16_t Follow_ULTRASONIC_Get = 0;
 void ApplicationFunctionSet::ApplicationFunctionSet_Follow(void)
 {
-  static uint16_t ULTRASONIC_Get = 0;
-  static unsigned long ULTRASONIC_time = 0;
   static uint8_t Position_Servo = 1;
   static uint8_t timestamp = 3;
   static uint8_t OneCycle = 1;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == Follow_mode)
+  if (Car_LeaveTheGround == false)
   {
+    ApplicationFunctionSet_SmartRobotCarEmergencyStop();
+    return;
+  }
+  AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(&Follow_ULTRASONIC_Get /*out*/);
+  //There is no obstacle 20 cm ahead?（the servo is still turning：keep scanning）
+  if (false == function_xxx(Follow_ULTRASONIC_Get, 0, 20) || false == AppServo.DeviceDriverSet_Servo_InPosition(1))
+  {
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+    static unsigned long time_Servo = 0;
+    static uint8_t Position_Servo_xx = 0;
 
-    if (Car_LeaveTheGround == false)
-    {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-      return;
-    }
-    AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(&ULTRASONIC_Get /*out*/);
-    if (false == function_xxx(ULTRASONIC_Get, 0, 20)) //There is no obstacle 20 cm ahead?
-    {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-      static unsigned long time_Servo = 0;
-      static uint8_t Position_Servo_xx = 0;
-
-      if (timestamp == 3)
+    if (timestamp == 3)
+    {
+      if (Position_Servo_xx != Position_Servo) //Act on servo motor：avoid loop execution
       {
-        if (Position_Servo_xx != Position_Servo) //Act on servo motor：avoid loop execution
-        {
-          Position_Servo_xx = Position_Servo; //Act on servo motor：rotation angle record
+        Position_Servo_xx = Position_Servo; //Act on servo motor：rotation angle record
 
-          if (Position_Servo == 1)
-          {
-            time_Servo = millis();
-            AppServo.DeviceDriverSet_Servo_control(80 /*Position_angle*/);
-          }
-          else if (Position_Servo == 2)
-          {
-            time_Servo = millis();
-            AppServo.DeviceDriverSet_Servo_control(20 /*Position_angle*/);
-          }
-          else if (Position_Servo == 3)
-          {
-            time_Servo = millis();
-            AppServo.DeviceDriverSet_Servo_control(80 /*Position_angle*/);
-          }
-          else if (Position_Servo == 4)
-          {
-            time_Servo = millis();
-            AppServo.DeviceDriverSet_Servo_control(150 /*Position_angle*/);
-          }
+        if (Position_Servo == 1)
+        {
+          time_Servo = millis();
+          AppServo.DeviceDriverSet_Servo_control(80 /*Position_angle*/);
         }
-      }
-      else
-      {
-        if (timestamp == 1)
+        else if (Position_Servo == 2)
         {
-          timestamp = 2;
           time_Servo = millis();
+          AppServo.DeviceDriverSet_Servo_control(20 /*Position_angle*/);
         }
-      }
-      if (millis() - time_Servo > 1000) //Act on servo motor：stop at the current location for 2s
-      {
-        timestamp = 3;
-        Position_Servo += 1;
-        OneCycle += 1;
-        if (OneCycle > 4)
+        else if (Position_Servo == 3)
+        {
+          time_Servo = millis();
+          AppServo.DeviceDriverSet_Servo_control(80 /*Position_angle*/);
+        }
+        else if (Position_Servo == 4)
         {
-          Position_Servo = 1;
-          OneCycle = 5;
+          time_Servo = millis();
+          AppServo.DeviceDriverSet_Servo_control(150 /*Position_angle*/);
         }
       }
     }
     else
     {
-      OneCycle = 1;
-      timestamp = 1;
-      if ((Position_Servo == 1))
-      { /*Move forward*/
-        ApplicationFunctionSet_SmartRobotCarMotionControl(Forward, 100);
-      }
-      else if ((Position_Servo == 2))
-      { /*Turn right*/
-        ApplicationFunctionSet_SmartRobotCarMotionControl(Right, 150);
-      }
-      else if ((Position_Servo == 3))
+      if (timestamp == 1)
       {
-        /*Move forward*/
-        ApplicationFunctionSet_SmartRobotCarMotionControl(Forward, 100);
+        timestamp = 2;
+        time_Servo = millis();
       }
-      else if ((Position_Servo == 4))
-      { /*Turn left*/
-        ApplicationFunctionSet_SmartRobotCarMotionControl(Left, 150);
+    }
+    if (millis() - time_Servo > 1000) //Act on servo motor：stop at the current location for 2s
+    {
+      timestamp = 3;
+      Position_Servo += 1;
+      OneCycle += 1;
+      if (OneCycle > 4)
+      {
+        Position_Servo = 1;
+        OneCycle = 5;
       }
     }
   }
   else
   {
-    ULTRASONIC_Get = 0;
-    ULTRASONIC_time = 0;
+    OneCycle = 1;
+    timestamp = 1;
+    if ((Position_Servo == 1))
+    { /*Move forward*/
+      ApplicationFunctionSet_SmartRobotCarMotionControl(Forward, 100);
+    }
+    else if ((Position_Servo == 2))
+    { /*Turn right*/
+      ApplicationFunctionSet_SmartRobotCarMotionControl(Right, 150);
+    }
+    else if ((Position_Servo == 3))
+    {
+      /*Move forward*/
+      ApplicationFunctionSet_SmartRobotCarMotionControl(Forward, 100);
+    }
+    else if ((Position_Servo == 4))
+    { /*Turn left*/
+      ApplicationFunctionSet_SmartRobotCarMotionControl(Left, 150);
+    }
   }
 }
 
@@ -877,36 +1312,10 @@ void ApplicationFunctionSet::ApplicationFunctionSet_Servo(uint8_t Set_Servo)
     break;
   }
 }
-/*Standby mode*/
+/*Standby mode：the yaw zero rate is learnt online while the car stands still (MPU6050_dveBias)*/
 void ApplicationFunctionSet::ApplicationFunctionSet_Standby(void)
 {
-  static bool is_ED = true;
-  static uint8_t cout = 0;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == Standby_mode)
-  {
-    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-    if (true == is_ED) //Used to zero yaw raw data(Make sure the car is placed on a stationary surface!)
-    {
-      static unsigned long timestamp; //acquire timestamp
-      if (millis() - timestamp > 20)
-      {
-        timestamp = millis();
-        if (ApplicationFunctionSet_SmartRobotCarLeaveTheGround() /* condition */)
-        {
-          cout += 1;
-        }
-        else
-        {
-          cout = 0;
-        }
-        if (cout > 10)
-        {
-          is_ED = false;
-          AppMPU6050getdata.MPU6050_calibration();
-        }
-      }
-    }
-  }
+  ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
 }
 
 /* 
@@ -932,193 +1341,84 @@ void ApplicationFunctionSet::CMD_inspect_xxx0(void)
                         uint8_t CMD_is_MotorSpeed,      motor speed  0-250
   No time limited
 */
-void ApplicationFunctionSet::CMD_MotorControl_xxx0(uint8_t is_MotorSelection, uint8_t is_MotorDirection, uint8_t is_MotorSpeed)
+static uint8_t CMD_MotorSpeed_A = 0;
+static uint8_t CMD_MotorSpeed_B = 0;
+void ApplicationFunctionSet::CMD_MotorControl_xxx0(void)
 {
-  static boolean MotorControl = false;
-  static uint8_t is_MotorSpeed_A = 0;
-  static uint8_t is_MotorSpeed_B = 0;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_MotorControl)
+  if (0 == CMD_is_MotorDirection)
+  {
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+  }
+  else
   {
-    MotorControl = true;
-    if (0 == is_MotorDirection)
+    switch (CMD_is_MotorSelection) //motor selection
     {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-    }
-    else
+    case 0:
     {
-      switch (is_MotorSelection) //motor selection
-      {
-      case 0:
-      {
-        is_MotorSpeed_A = is_MotorSpeed;
-        is_MotorSpeed_B = is_MotorSpeed;
-        if (1 == is_MotorDirection)
-        { //turn forward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_just, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else if (2 == is_MotorDirection)
-        { //turn backward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_back, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else
-        {
-          return;
-        }
+      CMD_MotorSpeed_A = CMD_is_MotorSpeed;
+      CMD_MotorSpeed_B = CMD_is_MotorSpeed;
+      if (1 == CMD_is_MotorDirection)
+      { //turn forward
+        ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ CMD_MotorSpeed_A,
+                                                          /*direction_B*/ direction_just, /*speed_B*/ CMD_MotorSpeed_B,
+                                                          /*controlED*/ control_enable); //Motor control
       }
-      break;
-      case 1:
-      {
-        is_MotorSpeed_A = is_MotorSpeed;
-        if (1 == is_MotorDirection)
-        { //turn forward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_void, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else if (2 == is_MotorDirection)
-        { //turn backward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_void, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else
-        {
-          return;
-        }
+      else if (2 == CMD_is_MotorDirection)
+      { //turn backward
+        ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_back, /*speed_A*/ CMD_MotorSpeed_A,
+                                                          /*direction_B*/ direction_back, /*speed_B*/ CMD_MotorSpeed_B,
+                                                          /*controlED*/ control_enable); //Motor control
       }
-      break;
-      case 2:
+      else
       {
-        is_MotorSpeed_B = is_MotorSpeed;
-        if (1 == is_MotorDirection)
-        { //turn forward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_void, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_just, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else if (2 == is_MotorDirection)
-        { //turn backward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_void, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_back, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else
-        {
-          return;
-        }
-      }
-      break;
-      default:
-        break;
+        return;
       }
     }
-  }
-  else
-  {
-    if (MotorControl == true)
-    {
-      MotorControl = false;
-      is_MotorSpeed_A = 0;
-      is_MotorSpeed_B = 0;
-    }
-  }
-}
-void ApplicationFunctionSet::CMD_MotorControl_xxx0(void)
-{
-  static boolean MotorControl = false;
-  static uint8_t is_MotorSpeed_A = 0;
-  static uint8_t is_MotorSpeed_B = 0;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_MotorControl)
-  {
-    MotorControl = true;
-    if (0 == CMD_is_MotorDirection)
-    {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-    }
-    else
-    {
-      switch (CMD_is_MotorSelection) //motor selection
-      {
-      case 0:
-      {
-        is_MotorSpeed_A = CMD_is_MotorSpeed;
-        is_MotorSpeed_B = CMD_is_MotorSpeed;
-        if (1 == CMD_is_MotorDirection)
-        { //turn forward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_just, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else if (2 == CMD_is_MotorDirection)
-        { //turn backward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_back, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else
-        {
-          return;
-        }
+    break;
+    case 1:
+    {
+      CMD_MotorSpeed_A = CMD_is_MotorSpeed;
+      if (1 == CMD_is_MotorDirection)
+      { //turn forward
+        ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ CMD_MotorSpeed_A,
+                                                          /*direction_B*/ direction_void, /*speed_B*/ CMD_MotorSpeed_B,
+                                                          /*controlED*/ control_enable); //Motor control
       }
-      break;
-      case 1:
-      {
-        is_MotorSpeed_A = CMD_is_MotorSpeed;
-        if (1 == CMD_is_MotorDirection)
-        { //turn forward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_void, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else if (2 == CMD_is_MotorDirection)
-        { //turn backward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_back, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_void, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else
-        {
-          return;
-        }
+      else if (2 == CMD_is_MotorDirection)
+      { //turn backward
+        ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_back, /*speed_A*/ CMD_MotorSpeed_A,
+                                                          /*direction_B*/ direction_void, /*speed_B*/ CMD_MotorSpeed_B,
+                                                          /*controlED*/ control_enable); //Motor control
       }
-      break;
-      case 2:
+      else
       {
-        is_MotorSpeed_B = CMD_is_MotorSpeed;
-        if (1 == CMD_is_MotorDirection)
-        { //turn forward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_void, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_just, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else if (2 == CMD_is_MotorDirection)
-        { //turn backward
-          AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_void, /*speed_A*/ is_MotorSpeed_A,
-                                                 /*direction_B*/ direction_back, /*speed_B*/ is_MotorSpeed_B,
-                                                 /*controlED*/ control_enable); //Motor control
-        }
-        else
-        {
-          return;
-        }
+        return;
       }
-      break;
-      default:
-        break;
+    }
+    break;
+    case 2:
+    {
+      CMD_MotorSpeed_B = CMD_is_MotorSpeed;
+      if (1 == CMD_is_MotorDirection)
+      { //turn forward
+        ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_void, /*speed_A*/ CMD_MotorSpeed_A,
+                                                          /*direction_B*/ direction_just, /*speed_B*/ CMD_MotorSpeed_B,
+                                                          /*controlED*/ control_enable); //Motor control
+      }
+      else if (2 == CMD_is_MotorDirection)
+      { //turn backward
+        ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_void, /*speed_A*/ CMD_MotorSpeed_A,
+                                                          /*direction_B*/ direction_back, /*speed_B*/ CMD_MotorSpeed_B,
+                                                          /*controlED*/ control_enable); //Motor control
+      }
+      else
+      {
+        return;
       }
     }
-  }
-  else
-  {
-    if (MotorControl == true)
-    {
-      MotorControl = false;
-      is_MotorSpeed_A = 0;
-      is_MotorSpeed_B = 0;
+    break;
+    default:
+      break;
     }
   }
 }
@@ -1144,344 +1444,309 @@ static void CMD_CarControl(uint8_t is_CarDirection, uint8_t is_CarSpeed)
   }
 }
 /*
-  N2：command
-  CMD mode：Receive the control commands from the APP,perform movement direction and speed control of the car
-  Time limited
+  N4 command
+  CMD mode：movement mode<motor control>
+  Receive the control commands from the APP,perform motion control of the left and right motors
 */
-void ApplicationFunctionSet::CMD_CarControlTimeLimit_xxx0(uint8_t is_CarDirection, uint8_t is_CarSpeed, uint32_t is_Timer)
+void ApplicationFunctionSet::CMD_MotorControlSpeed_xxx0(void)
 {
-  static boolean CarControl = false;
-  static boolean CarControl_TE = false; //Time stamp
-  static boolean CarControl_return = false;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_CarControl_TimeLimit) //enter time-limited control mode
+  if (CMD_is_MotorSpeed_L == 0 && CMD_is_MotorSpeed_R == 0)
   {
-    CarControl = true;
-    if (is_Timer != 0) //#1 if the pre-set time is not ... (zero)
-    {
-      if ((millis() - Application_SmartRobotCarxxx0.CMD_CarControl_Millis) > (is_Timer)) //check the timestamp
-      {
-        CarControl_TE = true;
-        ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_Programming_mode; /*set mode to programming mode<Waiting for the next set of control commands>*/
-        if (CarControl_return == false)
-        {
-
-#if _is_print
-          Serial.print('{' + CommandSerialNumber + "_ok}");
-#endif
-          CarControl_return = true;
-        }
-      }
-      else
-      {
-        CarControl_TE = false; //There still has time left
-        CarControl_return = false;
-      }
-    }
-    if (CarControl_TE == false)
-    {
-      CMD_CarControl(is_CarDirection, is_CarSpeed);
-    }
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
   }
   else
   {
-    if (CarControl == true)
-    {
-      CarControl_return = false;
-      CarControl = false;
-      Application_SmartRobotCarxxx0.CMD_CarControl_Millis = 0;
-    }
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ CMD_is_MotorSpeed_L,
+                                                      /*direction_B*/ direction_just, /*speed_B*/ CMD_is_MotorSpeed_R,
+                                                      /*controlED*/ control_enable); //Motor control
   }
 }
 
-void ApplicationFunctionSet::CMD_CarControlTimeLimit_xxx0(void)
+/*
+  N5:command
+  CMD mode：<servo motor control>
+*/
+void ApplicationFunctionSet::CMD_ServoControl_xxx0(void)
+{
+  AppServo.DeviceDriverSet_Servo_controls(/*uint8_t Servo*/ CMD_is_Servo, /*unsigned int Position_angle*/ CMD_is_Servo_angle / 10);
+  Application_SmartRobotCarxxx0.Functional_Mode = CMD_Programming_mode; /*set mode to programming mode<Waiting for the next set of control commands>*/
+}
+/*
+  N29:command
+  CMD mode：turn on the spot to a heading, closed loop on the gyro yaw (degrees, clockwise positive, 0 = heading at power up).
+  D1 0 relative：T degrees, D2 0 left / 1 right；D1 1 absolute：T 0~359, the shorter way round.
+  D3 yaw rate limit (°/s, 0：Turn_RateMax), D4 tolerance (°, 0：Turn_Tolerance).
+  Outer loop：yaw error -> yaw rate, Turn_Kp per second, limited to the rate limit；inner loop every HeadingHold_Period：
+  wheel duty = Turn_Kff * rate + Turn_Kr * rate error + integral of Turn_Ki * rate error, plus Turn_PwmMin to break the
+  tyres loose. Inside the tolerance the wheels stop；still inside it and turning slower than Turn_SettleRate after
+  Turn_Settle ms the turn has arrived. Runs as a queue primitive：{H_ok} on arrival, {H_false} at the timeout
+  (the time the turn takes at the rate limit plus Turn_Timeout).
+*/
+#define Turn_RateMax 120   //°/s
+#define Turn_Tolerance 2   //°
+#define Turn_SettleRate 10 //°/s
+#define Turn_Settle 100    //ms
+#define Turn_Timeout 3000  //ms
+#define Turn_PwmMin 40
+#define Turn_PwmMax 200
+#define Turn_Kp Q16_FromFloat(3.0)   //°/s per degree
+#define Turn_Kff Q16_FromFloat(0.3)  //PWM per °/s
+#define Turn_Kr Q16_FromFloat(0.3)   //PWM per °/s
+#define Turn_Ki Q16_FromFloat(2.0)   //PWM per degree (integral of the rate error)
+enum CMD_TurnStatus
+{
+  CMD_Turn_Running,
+  CMD_Turn_Arrived,
+  CMD_Turn_Failed,
+};
+static q16_t Turn_Target;       //Yaw to arrive at
+static q16_t Turn_Yaw_last;
+static q16_t Turn_Integral = 0; //PWM
+static q16_t Turn_Rate;         //°/s
+static q16_t Turn_Band;         //°
+static unsigned long Turn_millis;
+static unsigned long Turn_Start_millis;
+static unsigned long Turn_Settle_millis;
+static unsigned long Turn_Duration; //ms：timeout
+static void CMD_TurnStart(uint8_t is_Absolute, uint8_t is_Right, uint8_t is_Rate, uint8_t is_Tolerance, uint16_t is_Angle)
 {
-  static boolean CarControl = false;
-  static boolean CarControl_TE = false; //Time stamp
-  static boolean CarControl_return = false;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_CarControl_TimeLimit) //enter time-limited control mode
+  q16_t Yaw;
+  AppMPU6050getdata.MPU6050_dveGetEulerAngles(&Yaw);
+  q16_t error;
+  if (is_Absolute)
   {
-    CarControl = true;
-    if (CMD_is_CarTimer != 0) //#1 if the pre-set time is not ... (zero)
+    q16_t heading = Yaw % Q16_FromInt(360);
+    error = Q16_FromInt(is_Angle) - ((heading < 0) ? heading + Q16_FromInt(360) : heading);
+    if (error > Q16_FromInt(180))
     {
-      if ((millis() - Application_SmartRobotCarxxx0.CMD_CarControl_Millis) > (CMD_is_CarTimer)) //check the timestamp
-      {
-        CarControl_TE = true;
-        ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_Programming_mode; /*set mode to programming mode<Waiting for the next set of control commands>*/
-        if (CarControl_return == false)
-        {
-
-#if _is_print
-          Serial.print('{' + CommandSerialNumber + "_ok}");
-#endif
-          CarControl_return = true;
-        }
-      }
-      else
-      {
-        CarControl_TE = false; //There still has time left
-        CarControl_return = false;
-      }
+      error -= Q16_FromInt(360);
     }
-    if (CarControl_TE == false)
+    else if (error <= -Q16_FromInt(180))
     {
-      CMD_CarControl(CMD_is_CarDirection, CMD_is_CarSpeed);
+      error += Q16_FromInt(360);
     }
   }
   else
   {
-    if (CarControl == true)
-    {
-      CarControl_return = false;
-      CarControl = false;
-      Application_SmartRobotCarxxx0.CMD_CarControl_Millis = 0;
-    }
+    error = is_Right ? Q16_FromInt(is_Angle) : -Q16_FromInt(is_Angle);
   }
+  Turn_Target = Q16_Add(Yaw, error);
+  Turn_Yaw_last = Yaw;
+  Turn_Integral = 0;
+  Turn_Rate = Q16_FromInt((0 == is_Rate) ? Turn_RateMax : is_Rate);
+  Turn_Band = Q16_FromInt((0 == is_Tolerance) ? Turn_Tolerance : is_Tolerance);
+  Turn_Duration = (uint32_t)abs(Q16_ToInt(error)) * 1000 / Q16_ToInt(Turn_Rate) + Turn_Timeout;
+  Turn_millis = Turn_Start_millis = Turn_Settle_millis = millis();
 }
-/*
-  N3 command
-  CMD mode：Receive the control commands from the APP,perform movement direction and speed control of the car
-  No time limited
-*/
-void ApplicationFunctionSet::CMD_CarControlNoTimeLimit_xxx0(uint8_t is_CarDirection, uint8_t is_CarSpeed)
+static uint8_t CMD_TurnUpdate(void)
 {
-  static boolean CarControl = false;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_CarControl_NoTimeLimit) //enter no time-limited control mode
+  if (millis() - Turn_Start_millis > Turn_Duration)
   {
-    CarControl = true;
-    CMD_CarControl(is_CarDirection, is_CarSpeed);
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+    return CMD_Turn_Failed;
   }
-  else
+  if (millis() - Turn_millis < HeadingHold_Period)
+  {
+    return CMD_Turn_Running;
+  }
+  q16_t Yaw;
+  AppMPU6050getdata.MPU6050_dveGetEulerAngles(&Yaw);
+  unsigned long dt = millis() - Turn_millis; //ms
+  Turn_millis = millis();
+  q16_t rate = Q16_DivInt(Q16_MulInt(Q16_Sub(Yaw, Turn_Yaw_last), 1000), dt); //°/s
+  Turn_Yaw_last = Yaw;
+  if (Application_FunctionSet.Car_LeaveTheGround == false) //Lifted：wait on the ground again
   {
-    if (CarControl == true)
+    ApplicationFunctionSet_SmartRobotCarEmergencyStop();
+    Turn_Integral = 0;
+    Turn_Settle_millis = millis();
+    return CMD_Turn_Running;
+  }
+  q16_t error = Q16_Sub(Turn_Target, Yaw);
+  if (labs(error) <= Turn_Band)
+  {
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+    Turn_Integral = 0;
+    if (labs(rate) > Q16_FromInt(Turn_SettleRate))
     {
-      CarControl = false;
+      Turn_Settle_millis = millis();
     }
+    return (millis() - Turn_Settle_millis >= Turn_Settle) ? CMD_Turn_Arrived : CMD_Turn_Running;
   }
-}
-void ApplicationFunctionSet::CMD_CarControlNoTimeLimit_xxx0(void)
-{
-  static boolean CarControl = false;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_CarControl_NoTimeLimit) //enter no time-limited control mode
+  Turn_Settle_millis = millis();
+  q16_t rate_set = constrain(Q16_Mul(Turn_Kp, error), -Turn_Rate, Turn_Rate);
+  q16_t rate_error = Q16_Sub(rate_set, rate);
+  Turn_Integral = constrain(Q16_Add(Turn_Integral, Q16_Mul(Q16_Mul(Turn_Ki, rate_error), Q16_FromRatio(dt, 1000))),
+                            -Q16_FromInt(Turn_PwmMax), Q16_FromInt(Turn_PwmMax));
+  int16_t pwm = Q16_ToInt(Q16_Add(Q16_Add(Q16_Mul(Turn_Kff, rate_set), Q16_Mul(Turn_Kr, rate_error)), Turn_Integral));
+  pwm = constrain(pwm + ((error > 0) ? Turn_PwmMin : -Turn_PwmMin), -Turn_PwmMax, Turn_PwmMax);
+  if (pwm >= 0) //Clockwise：right wheel back, left wheel forward
   {
-    CarControl = true;
-    CMD_CarControl(CMD_is_CarDirection, CMD_is_CarSpeed);
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_back, /*speed_A*/ pwm,
+                                                      /*direction_B*/ direction_just, /*speed_B*/ pwm, /*controlED*/ control_enable);
   }
   else
   {
-    if (CarControl == true)
-    {
-      CarControl = false;
-    }
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ direction_just, /*speed_A*/ -pwm,
+                                                      /*direction_B*/ direction_back, /*speed_B*/ -pwm, /*controlED*/ control_enable);
   }
+  return CMD_Turn_Running;
 }
 
 /*
-  N4 command
-  CMD mode：movement mode<motor control>
-  Receive the control commands from the APP,perform motion control of the left and right motors
+  N2/N3/N4/N7/N8/N29:command queue
+  CMD mode：primitives are queued in arrival order and run back to back, so the APP can send the next steps ahead.
+  A timed primitive (N2/N7 with T) ends when its timer expires and the next one starts from that instant;
+  an untimed one (N3/N4/N8, or T 0) runs until the next primitive is queued behind it；
+  an awaited one (N29) runs until it reports its own end, the next one starts after it.
+  Each primitive returns {H_ok} when it completes (untimed：when it starts；awaited：{H_ok} or {H_false}), so completions come in order.
+  Leaving the queue for another mode drops what is left：each dropped primitive that has not answered yet returns {H_false},
+  and a timed or awaited one that is running is stopped first.
 */
-void ApplicationFunctionSet::CMD_MotorControlSpeed_xxx0(uint8_t is_Speed_L, uint8_t is_Speed_R)
+#define CMD_Queue_Max 6
+#define CMD_Queue_H_Max 15
+struct CMD_QueueItem
+{
+  uint8_t N;
+  uint8_t D1;
+  uint8_t D2;
+  uint8_t D3;
+  uint8_t D4;
+  uint32_t T;
+  char H[CMD_Queue_H_Max + 1];
+};
+static CMD_QueueItem CMD_Queue[CMD_Queue_Max];
+static uint8_t CMD_Queue_Head = 0;
+static uint8_t CMD_Queue_Count = 0;
+static boolean CMD_Queue_Started = false;  //The head primitive is running
+static boolean CMD_Queue_Chain = false;    //The head primitive follows an expired timer without a gap
+static unsigned long CMD_Queue_Millis = 0; //Start time of the head primitive
+static boolean CMD_QueuePush(uint8_t N, const char *H, uint8_t D1, uint8_t D2, uint8_t D3, uint8_t D4, uint32_t T)
 {
-  static boolean MotorControl = false;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_MotorControl_Speed)
+  if (CMD_Queue_Count == CMD_Queue_Max)
   {
-    MotorControl = true;
-    if (is_Speed_L == 0 && is_Speed_R == 0)
-    {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
-    }
-    else
-    {
-      AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ is_Speed_L,
-                                             /*direction_B*/ direction_just, /*speed_B*/ is_Speed_R,
-                                             /*controlED*/ control_enable); //Motor control
-    }
+    return false;
   }
+  CMD_QueueItem *item = &CMD_Queue[(CMD_Queue_Head + CMD_Queue_Count) % CMD_Queue_Max];
+  item->N = N;
+  item->D1 = D1;
+  item->D2 = D2;
+  item->D3 = D3;
+  item->D4 = D4;
+  item->T = T;
+  size_t H_length = strnlen(H, sizeof(item->H) - 1); //Cut to CMD_Queue_H_Max, always terminated
+  memcpy(item->H, H, H_length);
+  item->H[H_length] = '\0';
+  CMD_Queue_Count++;
+  return true;
+}
+static boolean CMD_QueueTimed(const CMD_QueueItem *item)
+{
+  return (item->T != 0) && (item->N == 2 || item->N == 7);
+}
+/*Stop a timed primitive the way its timer would, or a turn the way its timeout would*/
+static void CMD_QueueStop(const CMD_QueueItem *item)
+{
+  if (item->N == 2 || item->N == 29)
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
   else
+    FastLED.clear(true);
+}
+static void CMD_QueueClear(void)
+{
+  for (uint8_t i = 0; i < CMD_Queue_Count; i++)
   {
-    if (MotorControl == true)
+    CMD_QueueItem *item = &CMD_Queue[(CMD_Queue_Head + i) % CMD_Queue_Max];
+    if (0 == i && true == CMD_Queue_Started)
     {
-      MotorControl = false;
+      if (false == CMD_QueueTimed(item) && item->N != 29)
+      {
+        continue; //Untimed：answered when it started
+      }
+      CMD_QueueStop(item);
     }
+#if _is_print
+    CMD_Response(item->H, "false");
+#endif
   }
+  CMD_Queue_Head = 0;
+  CMD_Queue_Count = 0;
+  CMD_Queue_Started = false;
+  CMD_Queue_Chain = false;
 }
-void ApplicationFunctionSet::CMD_MotorControlSpeed_xxx0(void)
+static void CMD_QueueReturn(const char *H)
+{
+#if _is_print
+  CMD_Response(H, "ok");
+#endif
+}
+void ApplicationFunctionSet::CMD_Queue_xxx0(void)
 {
-  static boolean MotorControl = false;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_MotorControl_Speed)
+  while (CMD_Queue_Count > 0)
   {
-    MotorControl = true;
-    if (CMD_is_MotorSpeed_L == 0 && CMD_is_MotorSpeed_R == 0)
+    CMD_QueueItem *item = &CMD_Queue[CMD_Queue_Head];
+    boolean timed = CMD_QueueTimed(item);
+    boolean awaited = (item->N == 29);
+    if (false == CMD_Queue_Started)
     {
-      ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+      CMD_Queue_Started = true;
+      if (false == CMD_Queue_Chain)
+      {
+        CMD_Queue_Millis = millis();
+      }
+      CMD_Queue_Chain = false;
+      if (true == awaited)
+      {
+        CMD_TurnStart(item->D1, item->D2, item->D3, item->D4, item->T);
+      }
+      else if (false == timed)
+      {
+        CMD_QueueReturn(item->H);
+      }
     }
-    else
+
+    if (true == awaited) //Turn：report its end and start the next one
     {
-      AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ direction_just, /*speed_A*/ CMD_is_MotorSpeed_L,
-                                             /*direction_B*/ direction_just, /*speed_B*/ CMD_is_MotorSpeed_R,
-                                             /*controlED*/ control_enable); //Motor control
+      uint8_t status = CMD_TurnUpdate();
+      if (CMD_Turn_Running == status)
+      {
+        return;
+      }
+#if _is_print
+      CMD_Response(item->H, (CMD_Turn_Arrived == status) ? "ok" : "false");
+#endif
     }
-  }
-  else
-  {
-    if (MotorControl == true)
+    else if (true == timed && (millis() - CMD_Queue_Millis) >= item->T) //Timer expired：stop, report and start the next one now
     {
-      MotorControl = false;
+      CMD_QueueStop(item);
+      CMD_QueueReturn(item->H);
+      CMD_Queue_Millis += item->T;
+      CMD_Queue_Chain = true;
     }
-  }
-}
-
-/*
-  N5:command
-  CMD mode：<servo motor control>
-*/
-void ApplicationFunctionSet::CMD_ServoControl_xxx0(void)
-{
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_ServoControl)
-  {
-    AppServo.DeviceDriverSet_Servo_controls(/*uint8_t Servo*/ CMD_is_Servo, /*unsigned int Position_angle*/ CMD_is_Servo_angle / 10);
-    Application_SmartRobotCarxxx0.Functional_Mode = CMD_Programming_mode; /*set mode to programming mode<Waiting for the next set of control commands>*/
-  }
-}
-/*
-  N7:command
-  CMD mode：<Lighting Control>
-  Time limited：Enter programming mode after the time is over
-*/
-void ApplicationFunctionSet::CMD_LightingControlTimeLimit_xxx0(uint8_t is_LightingSequence, uint8_t is_LightingColorValue_R, uint8_t is_LightingColorValue_G, uint8_t is_LightingColorValue_B,
-                                                               uint32_t is_LightingTimer)
-{
-  static boolean LightingControl = false;
-  static boolean LightingControl_TE = false; //Time stamp
-  static boolean LightingControl_return = false;
-
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_LightingControl_TimeLimit) //enter time-limited control mode
-  {
-    LightingControl = true;
-    if (is_LightingTimer != 0) //#1 if the pre-set time is not ... (zero)
-    {
-      if ((millis() - Application_SmartRobotCarxxx0.CMD_LightingControl_Millis) > (is_LightingTimer)) //Check the timestamp
-      {
-        LightingControl_TE = true;
-        FastLED.clear(true);
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_Programming_mode; /*set mode to programming mode<Waiting for the next set of control commands>*/
-        if (LightingControl_return == false)
-        {
-
-#if _is_print
-          Serial.print('{' + CommandSerialNumber + "_ok}");
-#endif
-          LightingControl_return = true;
-        }
-      }
-      else
-      {
-        LightingControl_TE = false; //There still has time left
-        LightingControl_return = false;
-      }
-    }
-    if (LightingControl_TE == false)
-    {
-      CMD_Lighting(is_LightingSequence, is_LightingColorValue_R, is_LightingColorValue_G, is_LightingColorValue_B);
-    }
-  }
-  else
-  {
-    if (LightingControl == true)
+    else if (true == timed || CMD_Queue_Count == 1) //Still running, or untimed with nothing behind it
     {
-      LightingControl_return = false;
-      LightingControl = false;
-      Application_SmartRobotCarxxx0.CMD_LightingControl_Millis = 0;
-    }
-  }
-}
-
-void ApplicationFunctionSet::CMD_LightingControlTimeLimit_xxx0(void)
-{
-  static boolean LightingControl = false;
-  static boolean LightingControl_TE = false; //Time stamp
-  static boolean LightingControl_return = false;
-
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_LightingControl_TimeLimit) //Enter Lighting Control mode with time-limited
-  {
-    LightingControl = true;
-    if (CMD_is_LightingTimer != 0) //#1 if the pre-set time is not ... (zero)
-    {
-      if ((millis() - Application_SmartRobotCarxxx0.CMD_LightingControl_Millis) > (CMD_is_LightingTimer)) //Check the timestamp
+      switch (item->N)
       {
-        LightingControl_TE = true;
-        FastLED.clear(true);
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_Programming_mode; /*set mode to programming mode<Waiting for the next set of control commands>*/
-        if (LightingControl_return == false)
-        {
-
-#if _is_print
-          Serial.print('{' + CommandSerialNumber + "_ok}");
-#endif
-          LightingControl_return = true;
-        }
-      }
-      else
-      {
-        LightingControl_TE = false; //There still has time left
-        LightingControl_return = false;
+      case 2:
+      case 3:
+        CMD_CarControl(item->D1, item->D2);
+        break;
+      case 4:
+        CMD_is_MotorSpeed_L = item->D1;
+        CMD_is_MotorSpeed_R = item->D2;
+        CMD_MotorControlSpeed_xxx0();
+        break;
+      default: /*N7/N8*/
+        CMD_Lighting(item->D1, item->D2, item->D3, item->D4);
+        break;
       }
+      return;
     }
-    if (LightingControl_TE == false)
-    {
-      CMD_Lighting(CMD_is_LightingSequence, CMD_is_LightingColorValue_R, CMD_is_LightingColorValue_G, CMD_is_LightingColorValue_B);
-    }
-  }
-  else
-  {
-    if (LightingControl == true)
-    {
-      LightingControl_return = false;
-      LightingControl = false;
-      Application_SmartRobotCarxxx0.CMD_LightingControl_Millis = 0;
-    }
-  }
-}
-/*
-  N8:command
-  CMD mode：<Lighting control>
-  No time limited
-*/
-void ApplicationFunctionSet::CMD_LightingControlNoTimeLimit_xxx0(uint8_t is_LightingSequence, uint8_t is_LightingColorValue_R, uint8_t is_LightingColorValue_G, uint8_t is_LightingColorValue_B)
-{
-  static boolean LightingControl = false;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_LightingControl_NoTimeLimit) //Enter Lighting Control mode without time-limited
-  {
-    LightingControl = true;
-    CMD_Lighting(is_LightingSequence, is_LightingColorValue_R, is_LightingColorValue_G, is_LightingColorValue_B);
-  }
-  else
-  {
-    if (LightingControl == true)
-    {
-      LightingControl = false;
-    }
-  }
-}
-void ApplicationFunctionSet::CMD_LightingControlNoTimeLimit_xxx0(void)
-{
-  static boolean LightingControl = false;
-  if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_LightingControl_NoTimeLimit) //Enter Lighting Control mode without time-limited
-  {
-    LightingControl = true;
-    CMD_Lighting(CMD_is_LightingSequence, CMD_is_LightingColorValue_R, CMD_is_LightingColorValue_G, CMD_is_LightingColorValue_B);
-  }
-  else
-  {
-    if (LightingControl == true)
-    {
-      LightingControl = false;
-    }
+    CMD_Queue_Head = (CMD_Queue_Head + 1) % CMD_Queue_Max;
+    CMD_Queue_Count--;
+    CMD_Queue_Started = false;
   }
+  Application_SmartRobotCarxxx0.Functional_Mode = CMD_Programming_mode; /*set mode to programming mode<Waiting for the next set of control commands>*/
 }
 
 /*
@@ -1492,7 +1757,7 @@ void ApplicationFunctionSet::CMD_ClearAllFunctions_xxx0(void)
 {
   if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_ClearAllFunctions_Standby_mode) //Command:N100 Clear all functions to enter standby mode
   {
-    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+    ApplicationFunctionSet_SmartRobotCarEmergencyStop();
     FastLED.clear(true);
     AppRBG_LED.DeviceDriverSet_RBGLED_xxx(0 /*Duration*/, NUM_LEDS /*Traversal_Number*/, CRGB::Black);
     Application_SmartRobotCarxxx0.Motion_Control = stop_it;
@@ -1501,7 +1766,7 @@ void ApplicationFunctionSet::CMD_ClearAllFunctions_xxx0(void)
   if (Application_SmartRobotCarxxx0.Functional_Mode == CMD_ClearAllFunctions_Programming_mode) //Command:N110 Clear all functions and enter programming mode
   {
 
-    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+    ApplicationFunctionSet_SmartRobotCarEmergencyStop();
     FastLED.clear(true);
     AppRBG_LED.DeviceDriverSet_RBGLED_xxx(0 /*Duration*/, NUM_LEDS /*Traversal_Number*/, CRGB::Black);
     Application_SmartRobotCarxxx0.Motion_Control = stop_it;
@@ -1516,29 +1781,29 @@ void ApplicationFunctionSet::CMD_ClearAllFunctions_xxx0(void)
 */
 void ApplicationFunctionSet::CMD_UltrasoundModuleStatus_xxx0(uint8_t is_get)
 {
-  AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(&UltrasoundData_cm /*out*/); //Ultrasonic data
+  uint16_t get_cm;
+  AppULTRASONIC.DeviceDriverSet_ULTRASONIC_Get(&get_cm /*out*/); //Ultrasonic data
+  UltrasoundData_cm = get_cm;
   UltrasoundDetectionStatus = function_xxx(UltrasoundData_cm, 0, ObstacleDetection);
   if (1 == is_get) //ultrasonic sensor  is_get Start     true：has obstacle / false: no obstable
   {
     if (true == UltrasoundDetectionStatus)
     {
 #if _is_print
-      Serial.print('{' + CommandSerialNumber + "_true}");
+      CMD_Response(CommandSerialNumber, "true");
 #endif
     }
     else
     {
 #if _is_print
-      Serial.print('{' + CommandSerialNumber + "_false}");
+      CMD_Response(CommandSerialNumber, "false");
 #endif
     }
   }
   else if (2 == is_get) //ultrasonic sensor is_get data
   {
-    char toString[10];
-    sprintf(toString, "%d", UltrasoundData_cm);
 #if _is_print
-    Serial.print('{' + CommandSerialNumber + '_' + toString + '}');
+    CMD_Response(CommandSerialNumber, (long)UltrasoundData_cm);
 #endif
   }
 }
@@ -1549,64 +1814,60 @@ void ApplicationFunctionSet::CMD_UltrasoundModuleStatus_xxx0(uint8_t is_get)
 */
 void ApplicationFunctionSet::CMD_TraceModuleStatus_xxx0(uint8_t is_get)
 {
-  char toString[10];
   if (0 == is_get) /*Get left IR sensor status*/
   {
-    sprintf(toString, "%d", TrackingData_L);
 #if _is_print
-    Serial.print('{' + CommandSerialNumber + '_' + toString + '}');
+    CMD_Response(CommandSerialNumber, (long)TrackingData_L);
 #endif
     /*
     if (true == TrackingDetectionStatus_L)
     {
 #if _is_print
-      Serial.print('{' + CommandSerialNumber + "_true}");
+      CMD_Response(CommandSerialNumber, "true");
 #endif
     }
     else
     {
 #if _is_print
-      Serial.print('{' + CommandSerialNumber + "_false}");
+      CMD_Response(CommandSerialNumber, "false");
 #endif
     }*/
   }
   else if (1 == is_get) /*Get middle IR sensor status*/
   {
-    sprintf(toString, "%d", TrackingData_M);
 #if _is_print
-    Serial.print('{' + CommandSerialNumber + '_' + toString + '}');
+    CMD_Response(CommandSerialNumber, (long)TrackingData_M);
 #endif
     /*
     if (true == TrackingDetectionStatus_M)
     {
 #if _is_print
-      Serial.print('{' + CommandSerialNumber + "_true}");
+      CMD_Response(CommandSerialNumber, "true");
 #endif
     }
     else
     {
 #if _is_print
-      Serial.print('{' + CommandSerialNumber + "_false}");
+      CMD_Response(CommandSerialNumber, "false");
 #endif
     }*/
   }
   else if (2 == is_get) /*Get right IR sensor status*/
   {
-    sprintf(toString, "%d", TrackingData_R);
 #if _is_print
-    Serial.print('{' + CommandSerialNumber + '_' + toString + '}');
+    CMD_Response(CommandSerialNumber, (long)TrackingData_R);
 #endif
     /*
         if (true == TrackingDetectionStatus_R)
     {
 #if _is_print
-      Serial.print('{' + CommandSerialNumber + "_true}");
+      CMD_Response(CommandSerialNumber, "true");
 #endif
     }
     else
     {
 #if _is_print
-      Serial.print('{' + CommandSerialNumber + "_false}");
+      CMD_Response(CommandSerialNumber, "false");
 #endif
     }*/
   }
@@ -1618,6 +1879,7 @@ void ApplicationFunctionSet::CMD_TraceModuleStatus_xxx0(uint8_t is_get)
  * Graphical programming and command control module
  $ Elegoo & SmartRobot & 2020-06
  --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+*/
 
 
 /*Key command*/
@@ -1700,25 +1962,31 @@ void ApplicationFunctionSet::ApplicationFunctionSet_IRrecv(void)
     case /* constant-expression */ 9:
       /* code */ if (Application_SmartRobotCarxxx0.Functional_Mode == TraceBased_mode) //Adjust the threshold of the line tracking module to adapt the actual environment
       {
-        if (TrackingDetection_S < 600)
+        for (uint8_t i = 0; i < 3; i++)
         {
-          TrackingDetection_S += 10;
+          if (TrackingDetection_S[i] + 10 < TrackingDetection_E[i])
+          {
+            TrackingDetection_S[i] += 10;
+          }
         }
       }
 
       break;
     case /* constant-expression */ 10:
-      /* code */ if (Application_SmartRobotCarxxx0.Functional_Mode == TraceBased_mode)
+      /* code */ if (Application_SmartRobotCarxxx0.Functional_Mode == TraceBased_mode) //Back to the calibrated thresholds
       {
-        TrackingDetection_S = 250;
+        ApplicationFunctionSet_TrackingCalibrationLoad();
       }
       break;
     case /* constant-expression */ 11:
       /* code */ if (Application_SmartRobotCarxxx0.Functional_Mode == TraceBased_mode)
       {
-        if (TrackingDetection_S > 30)
+        for (uint8_t i = 0; i < 3; i++)
         {
-          TrackingDetection_S -= 10;
+          if (TrackingDetection_S[i] > 30)
+          {
+            TrackingDetection_S[i] -= 10;
+          }
         }
       }
       break;
@@ -1767,25 +2035,448 @@ void ApplicationFunctionSet::ApplicationFunctionSet_IRrecv(void)
     }
   }
 }
-/*Data analysis on serial port*/
-void ApplicationFunctionSet::ApplicationFunctionSet_SerialPortDataAnalysis(void)
+/*
+  Serial frame receiver：fixed line buffer, no heap.
+  A JSON frame runs from '{' to '}'. Bytes outside a frame are skipped, a '{' inside a frame drops the partial frame and
+  starts a new one, and a frame longer than the buffer is discarded up to its '}' (resync on the next '{').
+  A binary frame is SLIP framed：END payload END, with END/ESC inside the payload sent as ESC ESC_END / ESC ESC_ESC.
+  JSON text never contains END, so the framing is told apart on each frame by its first byte.
+*/
+#define SerialPortData_Max 96
+#define SerialPortSLIP_END 0xC0
+#define SerialPortSLIP_ESC 0xDB
+#define SerialPortSLIP_ESC_END 0xDC
+#define SerialPortSLIP_ESC_ESC 0xDD
+enum SerialPortFrameType
 {
-  static String SerialPortData = "";
-  uint8_t c = "";
-  if (Serial.available() > 0)
+  SerialPortFrame_None,
+  SerialPortFrame_Json,
+  SerialPortFrame_Binary,
+};
+static char SerialPortData[SerialPortData_Max + 1];
+static uint8_t SerialPortData_Length = 0;
+static boolean SerialPortData_Begin = false;    //Inside a JSON frame
+static boolean SerialPortData_Binary = false;   //Inside a binary frame
+static boolean SerialPortData_Escape = false;   //Binary frame：last byte was ESC
+static boolean SerialPortData_Overflow = false; //Inside an oversized frame
+static uint16_t SerialPortData_Dropped = 0;     //Partial or undecodable frames
+static uint16_t SerialPortData_Oversized = 0;   //Frames longer than SerialPortData_Max
+static void ApplicationFunctionSet_SerialPortStore(char c)
+{
+  if (SerialPortData_Length < SerialPortData_Max)
+  {
+    SerialPortData[SerialPortData_Length++] = c;
+  }
+  else if (false == SerialPortData_Overflow)
   {
-    while (c != '}' && Serial.available() > 0)
+    SerialPortData_Overflow = true;
+    SerialPortData_Oversized++;
+  }
+}
+static SerialPortFrameType ApplicationFunctionSet_SerialPortFrame(void)
+{
+  while (Serial.available() > 0)
+  {
+    uint8_t c = Serial.read();
+    if (true == SerialPortData_Binary)
+    {
+      if (c == SerialPortSLIP_END)
+      {
+        if (SerialPortData_Length == 0 && false == SerialPortData_Overflow)
+        {
+          continue; //Leading END：the frame starts here
+        }
+        SerialPortData_Binary = false;
+        if (false == SerialPortData_Overflow)
+        {
+          return SerialPortFrame_Binary;
+        }
+      }
+      else if (c == SerialPortSLIP_ESC)
+      {
+        SerialPortData_Escape = true;
+      }
+      else
+      {
+        if (true == SerialPortData_Escape)
+        {
+          SerialPortData_Escape = false;
+          c = (c == SerialPortSLIP_ESC_END) ? SerialPortSLIP_END : (c == SerialPortSLIP_ESC_ESC) ? SerialPortSLIP_ESC : c;
+        }
+        ApplicationFunctionSet_SerialPortStore(c);
+      }
+      continue;
+    }
+    if (c == '{' || c == SerialPortSLIP_END)
     {
-      // while (Serial.available() == 0)//Forcibly wait for a frame of data to be received
-      //   ;
-      c = Serial.read();
-      SerialPortData += (char)c;
+      if (true == SerialPortData_Begin && false == SerialPortData_Overflow)
+      {
+        SerialPortData_Dropped++;
+      }
+      SerialPortData_Begin = (c == '{');
+      SerialPortData_Binary = (c == SerialPortSLIP_END);
+      SerialPortData_Escape = false;
+      SerialPortData_Overflow = false;
+      SerialPortData_Length = 0;
+    }
+    if (false == SerialPortData_Begin)
+    {
+      continue;
     }
+    ApplicationFunctionSet_SerialPortStore(c);
+    if (c == '}') //Data frame tail check
+    {
+      SerialPortData_Begin = false;
+      if (false == SerialPortData_Overflow)
+      {
+        SerialPortData[SerialPortData_Length] = '\0';
+        return SerialPortFrame_Json;
+      }
+    }
+  }
+  return SerialPortFrame_None;
+}
+/*
+  Command decoder：single pass over one '{…}' frame for the fixed key set N, H, D1~D4, T.
+  Keys may come in any order, missing keys read as 0 (H as ""), other keys are skipped whatever their value,
+  fractional numbers are truncated and true/false/null read as 1/0/0, as they were through ArduinoJson.
+*/
+#define SerialPortCommand_H_Max 15
+struct SerialPortCommand
+{
+  uint16_t N;
+  int16_t D1;
+  int16_t D2;
+  int16_t D3;
+  int16_t D4;
+  uint32_t T;
+  char H[SerialPortCommand_H_Max + 1];
+} __attribute__((packed));
+
+static const char *SerialPortDecode_Space(const char *p)
+{
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+    p++;
+  return p;
+}
+/*Skip a string starting at its opening quote, copying up to Length-1 characters to To (if given)*/
+static const char *SerialPortDecode_String(const char *p, char *To, uint8_t Length)
+{
+  uint8_t i = 0;
+  for (p++; *p != '"'; p++)
+  {
+    if (*p == '\0')
+      return NULL;
+    if (*p == '\\' && *++p == '\0')
+      return NULL;
+    if (To != NULL && i < Length - 1)
+      To[i++] = *p;
+  }
+  if (To != NULL)
+    To[i] = '\0';
+  return p + 1;
+}
+/*Skip a nested object or array, strings included*/
+static const char *SerialPortDecode_Nested(const char *p)
+{
+  uint8_t depth = 0;
+  do
+  {
+    if (*p == '"')
+    {
+      p = SerialPortDecode_String(p, NULL, 0);
+      if (p == NULL)
+        return NULL;
+      continue;
+    }
+    if (*p == '{' || *p == '[')
+      depth++;
+    else if (*p == '}' || *p == ']')
+      depth--;
+    else if (*p == '\0')
+      return NULL;
+    p++;
+  } while (depth > 0);
+  return p;
+}
+/*Read any scalar or nested value; numbers and literals land in *Value, strings in To*/
+static const char *SerialPortDecode_Value(const char *p, long *Value, char *To, uint8_t Length)
+{
+  *Value = 0;
+  if (To != NULL)
+    To[0] = '\0';
+  if (*p == '"')
+  {
+    return SerialPortDecode_String(p, To, Length);
+  }
+  if (*p == '-' || (*p >= '0' && *p <= '9'))
+  {
+    boolean negative = (*p == '-');
+    int8_t scale = 0; //Power of ten still to apply to *Value
+    if (negative)
+      p++;
+    if (*p < '0' || *p > '9')
+      return NULL;
+    for (; *p >= '0' && *p <= '9'; p++)
+    {
+      if (*Value < 100000000L)
+        *Value = *Value * 10 + (*p - '0');
+      else if (scale < 99)
+        scale++;
+    }
+    if (*p == '.')
+    {
+      for (p++; *p >= '0' && *p <= '9'; p++)
+      {
+        if (*Value < 100000000L)
+        {
+          *Value = *Value * 10 + (*p - '0');
+          scale--;
+        }
+      }
+    }
+    if (*p == 'e' || *p == 'E') //1e2 is 100, as through ArduinoJson
+    {
+      boolean minus = (*++p == '-');
+      int8_t exponent = 0;
+      if (*p == '-' || *p == '+')
+        p++;
+      for (; *p >= '0' && *p <= '9'; p++)
+        exponent = min(exponent * 10 + (*p - '0'), 99);
+      scale = constrain(scale + (minus ? -exponent : exponent), -99, 99);
+    }
+    for (; scale < 0 && *Value != 0; scale++)
+      *Value /= 10; //The fraction is truncated
+    for (; scale > 0 && *Value <= 214748364L; scale--)
+      *Value *= 10;
+    if (negative)
+      *Value = -*Value;
+    return p;
+  }
+  if (*p == '{' || *p == '[')
+  {
+    return SerialPortDecode_Nested(p);
+  }
+  if (strncmp(p, "true", 4) == 0)
+  {
+    *Value = 1;
+    return p + 4;
+  }
+  if (strncmp(p, "false", 5) == 0)
+    return p + 5;
+  if (strncmp(p, "null", 4) == 0)
+    return p + 4;
+  return NULL;
+}
+static boolean ApplicationFunctionSet_SerialPortDecode(const char *p, SerialPortCommand *Command)
+{
+  memset(Command, 0, sizeof(SerialPortCommand));
+  p = SerialPortDecode_Space(p);
+  if (*p++ != '{')
+    return false;
+  p = SerialPortDecode_Space(p);
+  if (*p == '}')
+    return true;
+  for (;;)
+  {
+    char key[4];
+    long value;
+    if (*p != '"' || (p = SerialPortDecode_String(p, key, sizeof(key))) == NULL)
+      return false;
+    p = SerialPortDecode_Space(p);
+    if (*p++ != ':')
+      return false;
+    p = SerialPortDecode_Space(p);
+    if (key[0] == 'H' && key[1] == '\0')
+      p = SerialPortDecode_Value(p, &value, Command->H, sizeof(Command->H));
+    else
+      p = SerialPortDecode_Value(p, &value, NULL, 0);
+    if (p == NULL)
+      return false;
+
+    if (key[1] == '\0')
+    {
+      if (key[0] == 'N')
+        Command->N = value;
+      else if (key[0] == 'T')
+        Command->T = value;
+    }
+    else if (key[0] == 'D' && key[2] == '\0')
+    {
+      switch (key[1])
+      {
+      case '1':
+        Command->D1 = value;
+        break;
+      case '2':
+        Command->D2 = value;
+        break;
+      case '3':
+        Command->D3 = value;
+        break;
+      case '4':
+        Command->D4 = value;
+        break;
+      }
+    }
+
+    p = SerialPortDecode_Space(p);
+    if (*p == '}')
+      return true;
+    if (*p++ != ',')
+      return false;
+    p = SerialPortDecode_Space(p);
+  }
+}
+/*
+  Binary command：SLIP payload = opcode [H] fields CRC-8.
+  opcode bit 0~6：N, bit 7：a one-byte serial number H follows (acknowledged as its decimal text).
+  The fields of each N are fixed by SerialPortBinary_Layout() (same table as SerialPortBinary.cpp on the ESP32)：
+  D1~D4 one byte each, T two bytes little endian.
+  CRC-8：polynomial 0x07, initial value 0, over opcode to last field.
+*/
+#define SerialPortBinary_H 0x80
+#define SerialPortBinary_D1 0x01
+#define SerialPortBinary_D2 0x02
+#define SerialPortBinary_D3 0x04
+#define SerialPortBinary_D4 0x08
+#define SerialPortBinary_T 0x10
+static uint8_t SerialPortBinary_Layout(uint8_t N)
+{
+  switch (N)
+  {
+  case 1:
+    return SerialPortBinary_D1 | SerialPortBinary_D2 | SerialPortBinary_D3;
+  case 2:
+    return SerialPortBinary_D1 | SerialPortBinary_D2 | SerialPortBinary_T;
+  case 3:
+  case 4:
+  case 5:
+  case 102:
+    return SerialPortBinary_D1 | SerialPortBinary_D2;
+  case 7:
+  case 29:
+    return SerialPortBinary_D1 | SerialPortBinary_D2 | SerialPortBinary_D3 | SerialPortBinary_D4 | SerialPortBinary_T;
+  case 8:
+  case 27: //Gains above 255 (the default Kd is 300) have no binary form and stay JSON
+    return SerialPortBinary_D1 | SerialPortBinary_D2 | SerialPortBinary_D3 | SerialPortBinary_D4;
+  case 21:
+  case 22:
+  case 24:
+  case 25:
+  case 26:
+  case 28:
+  case 101:
+  case 105:
+  case 106:
+    return SerialPortBinary_D1;
+  case 23:
+  case 100:
+  case 110:
+    return 0;
+  default:
+    return 0xFF; //No binary form
   }
-  if (c == '}') //Data frame tail check
+}
+static uint8_t SerialPortBinary_CRC8(const uint8_t *p, uint8_t Length)
+{
+  uint8_t crc = 0;
+  while (Length--)
+  {
+    crc ^= *p++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  return crc;
+}
+static boolean ApplicationFunctionSet_SerialPortBinary(const uint8_t *p, uint8_t Length, SerialPortCommand *Command)
+{
+  memset(Command, 0, sizeof(SerialPortCommand));
+  if (Length < 2 || SerialPortBinary_CRC8(p, Length - 1) != p[Length - 1])
+    return false;
+  uint8_t opcode = *p++;
+  uint8_t layout = SerialPortBinary_Layout(opcode & ~SerialPortBinary_H);
+  if (layout == 0xFF)
+    return false;
+  uint8_t expect = 2 + ((opcode & SerialPortBinary_H) ? 1 : 0) + ((layout & SerialPortBinary_T) ? 2 : 0);
+  for (uint8_t i = 0; i < 4; i++)
+    expect += (layout >> i) & 1;
+  if (Length != expect)
+    return false;
+
+  Command->N = opcode & ~SerialPortBinary_H;
+  if (opcode & SerialPortBinary_H)
+    utoa(*p++, Command->H, 10);
+  if (layout & SerialPortBinary_D1)
+    Command->D1 = *p++;
+  if (layout & SerialPortBinary_D2)
+    Command->D2 = *p++;
+  if (layout & SerialPortBinary_D3)
+    Command->D3 = *p++;
+  if (layout & SerialPortBinary_D4)
+    Command->D4 = *p++;
+  if (layout & SerialPortBinary_T)
+    Command->T = p[0] | ((uint16_t)p[1] << 8);
+  return true;
+}
+/*
+  Link speed negotiation (the ESP32 leads, both ends start at 9600)：
+  N 25 D1 rate index：answered {H_ok} at the old rate, then the UART moves to the new rate and waits for a probe.
+  N 26 H pattern D1 CRC-8 of pattern：answered {H_crc}；confirms a pending rate and doubles as link keepalive.
+  A rate that is not confirmed within SerialPortLink_ProbeTimeout is abandoned, and a raised rate with no frame decoded
+  for SerialPortLink_Timeout falls back to 9600, so a restarted ESP32 can negotiate again.
+*/
+#define SerialPortLink_ProbeTimeout 500
+#define SerialPortLink_Timeout 3000
+static const uint32_t SerialPortLink_Rate[] = {9600, 57600, 115200, 250000};
+static uint8_t SerialPortLink_Index = 0;
+static uint8_t SerialPortLink_Previous = 0;
+static boolean SerialPortLink_Pending = false;
+static unsigned long SerialPortLink_Millis = 0; //Rate change / last decoded frame
+static void SerialPortLink_Set(uint8_t Index)
+{
+  SerialPortTx_Flush();
+  Serial.begin(SerialPortLink_Rate[Index]);
+  SerialPortLink_Index = Index;
+  SerialPortLink_Millis = millis();
+}
+static void SerialPortLink_Update(void)
+{
+  if (true == SerialPortLink_Pending && (millis() - SerialPortLink_Millis) > SerialPortLink_ProbeTimeout)
+  {
+    SerialPortLink_Pending = false;
+    SerialPortLink_Set(SerialPortLink_Previous);
+  }
+  else if (SerialPortLink_Index != 0 && (millis() - SerialPortLink_Millis) > SerialPortLink_Timeout)
+  {
+    SerialPortLink_Set(0);
+  }
+}
+/*N2/N3/N4/N7/N8/N29：queue the primitive, {H_full} when the queue has no room*/
+static void ApplicationFunctionSet_SerialPortQueue(const SerialPortCommand *Command)
+{
+  if (CMD_QueuePush(Command->N, Command->H, Command->D1, Command->D2, Command->D3, Command->D4, Command->T))
+  {
+    Application_SmartRobotCarxxx0.Functional_Mode = CMD_Queue_mode;
+  }
+  else
+  {
+#if _is_print
+    CMD_Response(Command->H, "full");
+#endif
+  }
+}
+/*Data analysis on serial port*/
+void ApplicationFunctionSet::ApplicationFunctionSet_SerialPortDataAnalysis(void)
+{
+  SerialPortTx_Update();
+  SerialPortLink_Update();
+  SerialPortFrameType frame = ApplicationFunctionSet_SerialPortFrame();
+  if (frame != SerialPortFrame_None)
   {
 #if _Test_print
-    Serial.println(SerialPortData);
+    if (frame == SerialPortFrame_Json)
+      Serial.println(SerialPortData);
 #endif
     // if (true == SerialPortData.equals("{f}") || true == SerialPortData.equals("{b}") || true == SerialPortData.equals("{l}") || true == SerialPortData.equals("{r}"))
     // {
@@ -1798,120 +2489,167 @@ void ApplicationFunctionSet::ApplicationFunctionSet_SerialPortDataAnalysis(void)
     //   SerialPortData = "";
     //   return;
     // }
-    StaticJsonDocument<200> doc;                                       //Declare a JsonDocument object
-    DeserializationError error = deserializeJson(doc, SerialPortData); //Deserialize JSON data from the serial data buffer
-    SerialPortData = "";
-    if (error)
+    SerialPortCommand Command;
+    boolean decoded = (frame == SerialPortFrame_Json) ? ApplicationFunctionSet_SerialPortDecode(SerialPortData, &Command)
+                                                      : ApplicationFunctionSet_SerialPortBinary((const uint8_t *)SerialPortData, SerialPortData_Length, &Command);
+    if (false == decoded) //Decode the frame in the serial data buffer
     {
-      Serial.println("error:deserializeJson");
+      SerialPortData_Dropped++;
+      SerialPortTx_Print("error:deserializeJson\r\n", false);
     }
-    else if (!error) //Check if the deserialization is successful
+    else
     {
-      int control_mode_N = doc["N"];
-      char *temp = doc["H"];
-      CommandSerialNumber = temp; //Get the serial number of the new command
+      int control_mode_N = Command.N;
+      if (false == SerialPortLink_Pending)
+      {
+        SerialPortLink_Millis = millis();
+      }
+      strncpy(CommandSerialNumber, Command.H, sizeof(CommandSerialNumber) - 1); //Get the serial number of the new command
+      CommandSerialNumber[sizeof(CommandSerialNumber) - 1] = '\0';
 
       /*Please view the following code blocks in conjunction with the Communication protocol for Smart Robot Car.pdf*/
       switch (control_mode_N)
       {
       case 1: /*<Command：N 1> motor control mode */
         Application_SmartRobotCarxxx0.Functional_Mode = CMD_MotorControl;
-        CMD_is_MotorSelection = doc["D1"];
-        CMD_is_MotorSpeed = doc["D2"];
-        CMD_is_MotorDirection = doc["D3"];
+        CMD_is_MotorSelection = Command.D1;
+        CMD_is_MotorSpeed = Command.D2;
+        CMD_is_MotorDirection = Command.D3;
 
 #if _is_print
-        Serial.print('{' + CommandSerialNumber + "_ok}");
+        CMD_Response(CommandSerialNumber, "ok");
 #endif
         break;
 
-      case 2:                                                                     /*<Command：N 2> */
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_CarControl_TimeLimit; /*Car movement direction and speed control：Time limited mode*/
-        CMD_is_CarDirection = doc["D1"];
-        CMD_is_CarSpeed = doc["D2"];
-        CMD_is_CarTimer = doc["T"];
-        Application_SmartRobotCarxxx0.CMD_CarControl_Millis = millis();
+      case 2: /*<Command：N 2>：Car movement direction and speed control：Time limited mode*/
+      case 3: /*<Command：N 3>：Car movement direction and speed control：No time limited mode*/
+      case 4: /*<Command：N 4>：motor control:Control motor speed mode*/
+        ApplicationFunctionSet_SerialPortQueue(&Command);
+        break;
+      case 5:                                                             /*<Command：N 5> */
+        Application_SmartRobotCarxxx0.Functional_Mode = CMD_ServoControl; /*servo motor control*/
+        CMD_is_Servo = Command.D1;
+        CMD_is_Servo_angle = Command.D2;
 #if _is_print
-        //Serial.print('{' + CommandSerialNumber + "_ok}");
+        CMD_Response(CommandSerialNumber, "ok");
 #endif
         break;
+      case 7: /*<Command：N 7>：Lighting control:Time limited mode*/
+      case 8: /*<Command：N 8>：Lighting control:No time limited mode*/
+        ApplicationFunctionSet_SerialPortQueue(&Command);
+        break;
 
-      case 3:                                                                       /*<Command：N 3> */
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_CarControl_NoTimeLimit; /*Car movement direction and speed control：No time limited mode*/
-        CMD_is_CarDirection = doc["D1"];
-        CMD_is_CarSpeed = doc["D2"];
+      case 21: /*<Command：N 21>：ultrasonic sensor: detect obstacle distance */
+        CMD_UltrasoundModuleStatus_xxx0(Command.D1);
 #if _is_print
-        Serial.print('{' + CommandSerialNumber + "_ok}");
+        //CMD_Response(CommandSerialNumber, "ok");
 #endif
         break;
 
-      case 4:                                                                   /*<Command：N 4> */
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_MotorControl_Speed; /*motor control:Control motor speed mode*/
-        CMD_is_MotorSpeed_L = doc["D1"];
-        CMD_is_MotorSpeed_R = doc["D2"];
+      case 22: /*<Command：N 22>：IR sensor：for line tracking mode */
+        CMD_TraceModuleStatus_xxx0(Command.D1);
 #if _is_print
-        Serial.print('{' + CommandSerialNumber + "_ok}");
+        //CMD_Response(CommandSerialNumber, "ok");
 #endif
         break;
-      case 5:                                                             /*<Command：N 5> */
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_ServoControl; /*servo motor control*/
-        CMD_is_Servo = doc["D1"];
-        CMD_is_Servo_angle = doc["D2"];
+
+      case 23: /*<Command：N 23>：Check if the car leaves the ground */
+        if (true == Car_LeaveTheGround)
+        {
 #if _is_print
-        Serial.print('{' + CommandSerialNumber + "_ok}");
+          CMD_Response(CommandSerialNumber, "false");
 #endif
-        break;
-      case 7:                                                                          /*<Command：N 7> */
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_LightingControl_TimeLimit; /*Lighting control:Time limited mode*/
-
-        CMD_is_LightingSequence = doc["D1"]; //Lighting (Left, front, right, back and center)
-        CMD_is_LightingColorValue_R = doc["D2"];
-        CMD_is_LightingColorValue_G = doc["D3"];
-        CMD_is_LightingColorValue_B = doc["D4"];
-        CMD_is_LightingTimer = doc["T"];
-        Application_SmartRobotCarxxx0.CMD_LightingControl_Millis = millis();
+        }
+        else if (false == Car_LeaveTheGround)
+        {
 #if _is_print
-        //Serial.print('{' + CommandSerialNumber + "_ok}");
+          CMD_Response(CommandSerialNumber, "true");
 #endif
+        }
         break;
 
-      case 8:                                                                            /*<Command：N 8> */
-        Application_SmartRobotCarxxx0.Functional_Mode = CMD_LightingControl_NoTimeLimit; /*Lighting control:No time limited mode*/
-
-        CMD_is_LightingSequence = doc["D1"]; //Lighting (Left, front, right, back and center)
-        CMD_is_LightingColorValue_R = doc["D2"];
-        CMD_is_LightingColorValue_G = doc["D3"];
-        CMD_is_LightingColorValue_B = doc["D4"];
+      case 24: /*<Command：N 24>：Serial port status：D1 1 dropped frames / 2 oversized frames / 3 dropped output / 4 baud rate*/
+      {
+        uint8_t is_get = Command.D1;
 #if _is_print
-        Serial.print('{' + CommandSerialNumber + "_ok}");
+        CMD_Response(CommandSerialNumber, (1 == is_get) ? (long)SerialPortData_Dropped : (2 == is_get) ? (long)SerialPortData_Oversized : (3 == is_get) ? (long)SerialPortTx_Dropped : (long)SerialPortLink_Rate[SerialPortLink_Index]);
 #endif
-        break;
+      }
+      break;
 
-      case 21: /*<Command：N 21>：ultrasonic sensor: detect obstacle distance */
-        CMD_UltrasoundModuleStatus_xxx0(doc["D1"]);
+      case 25: /*<Command：N 25>：Link speed step：D1 rate index 0 9600 / 1 57600 / 2 115200 / 3 250000*/
+        if (Command.D1 >= 0 && Command.D1 < (int16_t)(sizeof(SerialPortLink_Rate) / sizeof(SerialPortLink_Rate[0])) && false == SerialPortLink_Pending)
+        {
+          CMD_Response(CommandSerialNumber, "ok");
+          SerialPortLink_Previous = SerialPortLink_Index;
+          SerialPortLink_Pending = true;
+          SerialPortLink_Set(Command.D1);
+        }
+        else
+        {
 #if _is_print
-        //Serial.print('{' + CommandSerialNumber + "_ok}");
+          CMD_Response(CommandSerialNumber, "false");
 #endif
+        }
         break;
 
-      case 22: /*<Command：N 22>：IR sensor：for line tracking mode */
-        CMD_TraceModuleStatus_xxx0(doc["D1"]);
+      case 26: /*<Command：N 26>：Link probe：D1 CRC-8 of H*/
+        if (SerialPortBinary_CRC8((const uint8_t *)CommandSerialNumber, strlen(CommandSerialNumber)) == (uint8_t)Command.D1)
+        {
+          SerialPortLink_Pending = false;
+          SerialPortLink_Millis = millis();
+          CMD_Response(CommandSerialNumber, (long)(uint8_t)Command.D1);
+        }
+        else
+        {
+          SerialPortData_Dropped++;
+        }
+        break;
+
+      case 27: /*<Command：N 27>：Line tracking gains：D1 Kp / D2 Ki / D3 Kd (all 1/1000), D4 top speed (0 keeps it)；all 0 only reads them*/
+        if (Command.D1 != 0 || Command.D2 != 0 || Command.D3 != 0 || Command.D4 != 0)
+        {
+          Tracking_Kp = Command.D1;
+          Tracking_Ki = Command.D2;
+          Tracking_Kd = Command.D3;
+          if (Command.D4 != 0)
+          {
+            Tracking_Speed = constrain(Command.D4, Tracking_Speed_Min, 255);
+          }
+        }
 #if _is_print
-        //Serial.print('{' + CommandSerialNumber + "_ok}");
+        CMD_ResponseBegin(CommandSerialNumber);
+        CMD_ResponseNumber(Tracking_Kp);
+        CMD_ResponseNumber(Tracking_Ki);
+        CMD_ResponseNumber(Tracking_Kd);
+        CMD_ResponseNumber(Tracking_Speed);
+        CMD_ResponseEnd();
 #endif
         break;
 
-      case 23: /*<Command：N 23>：Check if the car leaves the ground */
-        if (true == Car_LeaveTheGround)
+      case 28: /*<Command：N 28>：Line sensor calibration：D1 0 sweep and store, answered {H_ok_minL_maxL_minM_maxM_minR_maxR} (or _false) at the end / D1 1 back to defaults*/
+        if (1 == Command.D1)
         {
+          ApplicationFunctionSet_TrackingCalibrationClear();
 #if _is_print
-          Serial.print('{' + CommandSerialNumber + "_false}");
+          CMD_Response(CommandSerialNumber, "ok");
 #endif
         }
-        else if (false == Car_LeaveTheGround)
+        else
+        {
+          ApplicationFunctionSet_TrackingCalibrationStart(CommandSerialNumber);
+        }
+        break;
+
+      case 29: /*<Command：N 29>：Turn to heading：D1 0 relative (T degrees, D2 0 left / 1 right) / 1 absolute (T 0~359), D3 rate limit °/s, D4 tolerance °；{H_ok} on arrival*/
+        if ((0 == Command.D1 && Command.T <= 3600) || (1 == Command.D1 && Command.T < 360))
+        {
+          ApplicationFunctionSet_SerialPortQueue(&Command);
+        }
+        else
         {
 #if _is_print
-          Serial.print('{' + CommandSerialNumber + "_true}");
+          CMD_Response(CommandSerialNumber, "false");
 #endif
         }
         break;
@@ -1919,71 +2657,71 @@ void ApplicationFunctionSet::ApplicationFunctionSet_SerialPortDataAnalysis(void)
       case 110:                                                                                 /*<Command：N 110> */
         Application_SmartRobotCarxxx0.Functional_Mode = CMD_ClearAllFunctions_Programming_mode; /*Clear all function:Enter programming mode*/
 #if _is_print
-        Serial.print('{' + CommandSerialNumber + "_ok}");
+        CMD_Response(CommandSerialNumber, "ok");
 #endif
         break;
       case 100:                                                                             /*<Command：N 100> */
         Application_SmartRobotCarxxx0.Functional_Mode = CMD_ClearAllFunctions_Standby_mode; /*Clear all function:Enter standby mode*/
 #if _is_print
-        Serial.print("{ok}");
-        //Serial.print('{' + CommandSerialNumber + "_ok}");
+        SerialPortTx_Print("{ok}", true);
+        //CMD_Response(CommandSerialNumber, "ok");
 #endif
         break;
 
       case 101: /*<Command：N 101> :remote control to switch the car mode*/
-        if (1 == doc["D1"])
+        if (1 == Command.D1)
         {
           Application_SmartRobotCarxxx0.Functional_Mode = TraceBased_mode;
         }
-        else if (2 == doc["D1"])
+        else if (2 == Command.D1)
         {
           Application_SmartRobotCarxxx0.Functional_Mode = ObstacleAvoidance_mode;
         }
-        else if (3 == doc["D1"])
+        else if (3 == Command.D1)
         {
           Application_SmartRobotCarxxx0.Functional_Mode = Follow_mode;
         }
 
 #if _is_print
-        Serial.print("{ok}");
-        //Serial.print('{' + CommandSerialNumber + "_ok}");
+        SerialPortTx_Print("{ok}", true);
+        //CMD_Response(CommandSerialNumber, "ok");
 #endif
         break;
 
       case 105: /*<Command：N 105> :FastLED brightness adjustment control command*/
-        if (1 == doc["D1"] && (CMD_is_FastLED_setBrightness < 250))
+        if (1 == Command.D1 && (CMD_is_FastLED_setBrightness < 250))
         {
           CMD_is_FastLED_setBrightness += 5;
         }
-        else if (2 == doc["D1"] && (CMD_is_FastLED_setBrightness > 0))
+        else if (2 == Command.D1 && (CMD_is_FastLED_setBrightness > 0))
         {
           CMD_is_FastLED_setBrightness -= 5;
         }
         FastLED.setBrightness(CMD_is_FastLED_setBrightness);
 
 #if _Test_print
-        //Serial.print('{' + CommandSerialNumber + "_ok}");
-        Serial.print("{ok}");
+        //CMD_Response(CommandSerialNumber, "ok");
+        SerialPortTx_Print("{ok}", true);
 #endif
         break;
 
       case 106: /*<Command：N 106> */
       {
-        uint8_t temp_Set_Servo = doc["D1"];
+        uint8_t temp_Set_Servo = Command.D1;
         if (temp_Set_Servo > 5 || temp_Set_Servo < 1)
           return;
         ApplicationFunctionSet_Servo(temp_Set_Servo);
       }
 
 #if _is_print
-        //Serial.print('{' + CommandSerialNumber + "_ok}");
-        Serial.print("{ok}");
+        //CMD_Response(CommandSerialNumber, "ok");
+        SerialPortTx_Print("{ok}", true);
 #endif
         break;
       case 102: /*<Command：N 102> :Rocker control mode command*/
         Application_SmartRobotCarxxx0.Functional_Mode = Rocker_mode;
-        Rocker_temp = doc["D1"];
-        Rocker_CarSpeed = doc["D2"];
+        Rocker_temp = Command.D1;
+        Rocker_CarSpeed = Command.D2;
         
         switch (Rocker_temp)
         {
@@ -2020,7 +2758,7 @@ void ApplicationFunctionSet::ApplicationFunctionSet_SerialPortDataAnalysis(void)
           break;
         }
 #if _is_print
-        // Serial.print('{' + CommandSerialNumber + "_ok}");
+        // CMD_Response(CommandSerialNumber, "ok");
 #endif
         break;
 
@@ -2030,3 +2768,229 @@ void ApplicationFunctionSet::ApplicationFunctionSet_SerialPortDataAnalysis(void)
     }
   }
 }
+
+/*
+  Line sensor calibration：N 28 with the car standing across the line.
+  The car turns on the spot right, left and back (TrackingCalibration_Sweep each way) so every sensor passes over line
+  and floor, and the lowest (floor) and highest (line) reading of each sensor is recorded from every ADC scan.
+  Each sensor's line window becomes S = min + span / 4, E = max + span / 4 (kept below TrackingDetection_V),
+  so every sensor reads 750 on the line after normalization whatever its own gain.
+  The windows are stored in EEPROM behind a version and CRC-8 header and loaded in ApplicationFunctionSet_Init();
+  a missing or damaged record leaves the 250/850 defaults.
+*/
+#define TrackingCalibration_Address 0
+#define TrackingCalibration_Version 1
+#define TrackingCalibration_Sweep 400    //ms：quarter of the sweep
+#define TrackingCalibration_SpanMin 200  //Line/floor contrast below this：calibration refused
+struct TrackingCalibration
+{
+  uint8_t Version;
+  uint8_t CRC;
+  uint16_t S[3];
+  uint16_t E[3];
+};
+static uint16_t TrackingCalibration_Min[3];
+static uint16_t TrackingCalibration_Max[3];
+static uint16_t TrackingCalibration_Sequence = 0;
+static unsigned long TrackingCalibration_millis = 0;
+static char TrackingCalibration_H[sizeof(Application_FunctionSet.CommandSerialNumber)];
+static uint8_t TrackingCalibration_CRC8(const TrackingCalibration *Record)
+{
+  return SerialPortBinary_CRC8((const uint8_t *)Record->S, sizeof(Record->S) + sizeof(Record->E));
+}
+static void ApplicationFunctionSet_TrackingCalibrationLoad(void)
+{
+  TrackingCalibration Record;
+  EEPROM.get(TrackingCalibration_Address, Record);
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    if (Record.Version == TrackingCalibration_Version && Record.CRC == TrackingCalibration_CRC8(&Record))
+    {
+      Application_FunctionSet.TrackingDetection_S[i] = Record.S[i];
+      Application_FunctionSet.TrackingDetection_E[i] = Record.E[i];
+    }
+    else
+    {
+      Application_FunctionSet.TrackingDetection_S[i] = 250;
+      Application_FunctionSet.TrackingDetection_E[i] = 850;
+    }
+  }
+}
+static void ApplicationFunctionSet_TrackingCalibrationStart(const char *H)
+{
+  strncpy(TrackingCalibration_H, H, sizeof(TrackingCalibration_H) - 1);
+  TrackingCalibration_H[sizeof(TrackingCalibration_H) - 1] = '\0';
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    TrackingCalibration_Min[i] = 1023;
+    TrackingCalibration_Max[i] = 0;
+  }
+  TrackingCalibration_Sequence = 0;
+  TrackingCalibration_millis = millis();
+  Application_SmartRobotCarxxx0.Functional_Mode = TrackingCalibration_mode;
+}
+/*Erase the stored calibration (N 28 D1 1)*/
+static void ApplicationFunctionSet_TrackingCalibrationClear(void)
+{
+  EEPROM.update(TrackingCalibration_Address, 0xFF);
+  ApplicationFunctionSet_TrackingCalibrationLoad();
+}
+void ApplicationFunctionSet::ApplicationFunctionSet_TrackingCalibration(void)
+{
+  unsigned long elapsed = millis() - TrackingCalibration_millis;
+  int Data[3];
+  uint16_t sequence = AppITR20001.DeviceDriverSet_ITR20001_Get(&Data[0], &Data[1], &Data[2]);
+  if (sequence != TrackingCalibration_Sequence)
+  {
+    TrackingCalibration_Sequence = sequence;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      TrackingCalibration_Min[i] = min(TrackingCalibration_Min[i], (uint16_t)Data[i]);
+      TrackingCalibration_Max[i] = max(TrackingCalibration_Max[i], (uint16_t)Data[i]);
+    }
+  }
+
+  if (Car_LeaveTheGround == false) //Lifted：finish now, the span check then refuses the readings
+  {
+    elapsed = 4 * TrackingCalibration_Sweep;
+    TrackingCalibration_Max[0] = 0;
+  }
+  if (elapsed < TrackingCalibration_Sweep)
+  {
+    ApplicationFunctionSet_SmartRobotCarMotionControl(Right, 100);
+  }
+  else if (elapsed < 3 * TrackingCalibration_Sweep)
+  {
+    ApplicationFunctionSet_SmartRobotCarMotionControl(Left, 100);
+  }
+  else if (elapsed < 4 * TrackingCalibration_Sweep)
+  {
+    ApplicationFunctionSet_SmartRobotCarMotionControl(Right, 100);
+  }
+  else
+  {
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+    TrackingCalibration Record;
+    boolean valid = true;
+    Record.Version = TrackingCalibration_Version;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      uint16_t span = (TrackingCalibration_Max[i] > TrackingCalibration_Min[i]) ? TrackingCalibration_Max[i] - TrackingCalibration_Min[i] : 0;
+      if (span < TrackingCalibration_SpanMin || TrackingCalibration_Max[i] >= TrackingDetection_V)
+      {
+        valid = false;
+      }
+      Record.S[i] = TrackingCalibration_Min[i] + span / 4;
+      Record.E[i] = min((uint16_t)(TrackingCalibration_Max[i] + span / 4), (uint16_t)(TrackingDetection_V - 1));
+    }
+    if (true == valid)
+    {
+      Record.CRC = TrackingCalibration_CRC8(&Record);
+      EEPROM.put(TrackingCalibration_Address, Record);
+      ApplicationFunctionSet_TrackingCalibrationLoad();
+    }
+#if _is_print
+    CMD_ResponseBegin(TrackingCalibration_H);
+    CMD_ResponseText((true == valid) ? "ok" : "false");
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      CMD_ResponseNumber(TrackingCalibration_Min[i]);
+      CMD_ResponseNumber(TrackingCalibration_Max[i]);
+    }
+    CMD_ResponseEnd();
+#endif
+    Application_SmartRobotCarxxx0.Functional_Mode = CMD_Programming_mode; /*set mode to programming mode<Waiting for the next set of control commands>*/
+  }
+}
+
+/*
+  Mode dispatch：run the exit hook of the previous mode and the enter hook of the new mode on every mode change,
+  then run the handler of the active mode only (the mode handlers no longer check Functional_Mode themselves).
+*/
+static void ApplicationFunctionSet_ModeEnter(SmartRobotCarFunctionalModel Functional_Mode)
+{
+  switch (Functional_Mode)
+  {
+  case TraceBased_mode:
+    Tracking_timestamp = true;
+    Tracking_BlindDetection = true;
+    Tracking_MotorRL_time = 0;
+    Tracking_Error = 0;
+    Tracking_Integral = 0;
+    Tracking_millis = millis() - Tracking_Period;
+    break;
+  case ObstacleAvoidance_mode:
+    ApplicationFunctionSet_ObstacleState(Obstacle_Cruise); //modulate the steering gear to 90 degrees
+    break;
+  case Follow_mode:
+    Follow_ULTRASONIC_Get = 0;
+    break;
+  default:
+    break;
+  }
+}
+static void ApplicationFunctionSet_ModeExit(SmartRobotCarFunctionalModel Functional_Mode)
+{
+  switch (Functional_Mode)
+  {
+  case CMD_MotorControl:
+    CMD_MotorSpeed_A = 0;
+    CMD_MotorSpeed_B = 0;
+    break;
+  case CMD_Queue_mode: //Any other mode drops the primitives still queued, {H_false} for each
+    CMD_QueueClear();
+    break;
+  case TrackingCalibration_mode: //Interrupted sweep：nothing stored
+    ApplicationFunctionSet_SmartRobotCarMotionControl(stop_it, 0);
+    break;
+  default:
+    break;
+  }
+}
+void ApplicationFunctionSet::ApplicationFunctionSet_ModeDispatch(void)
+{
+  static SmartRobotCarFunctionalModel Functional_Mode = Standby_mode;
+  if (Functional_Mode != Application_SmartRobotCarxxx0.Functional_Mode)
+  {
+    ApplicationFunctionSet_ModeExit(Functional_Mode);
+    Functional_Mode = Application_SmartRobotCarxxx0.Functional_Mode;
+    ApplicationFunctionSet_ModeEnter(Functional_Mode);
+  }
+  switch (Functional_Mode)
+  {
+  case Standby_mode:
+    ApplicationFunctionSet_Standby();
+    break;
+  case TraceBased_mode:
+    ApplicationFunctionSet_Tracking();
+    break;
+  case ObstacleAvoidance_mode:
+    ApplicationFunctionSet_Obstacle();
+    break;
+  case Follow_mode:
+    ApplicationFunctionSet_Follow();
+    break;
+  case Rocker_mode:
+    ApplicationFunctionSet_Rocker();
+    break;
+  case CMD_ClearAllFunctions_Standby_mode:
+  case CMD_ClearAllFunctions_Programming_mode:
+    CMD_ClearAllFunctions_xxx0();
+    break;
+  case CMD_MotorControl: /*N1*/
+    CMD_MotorControl_xxx0();
+    break;
+  case CMD_ServoControl: /*N5*/
+    CMD_ServoControl_xxx0();
+    break;
+  case CMD_Queue_mode: /*N2/N3/N4/N7/N8/N29*/
+    CMD_Queue_xxx0();
+    break;
+  case TrackingCalibration_mode: /*N28*/
+    ApplicationFunctionSet_TrackingCalibration();
+    break;
+  default: /*CMD_Programming_mode：waiting for the next set of control commands*/
+    break;
+  }
+  ApplicationFunctionSet_SmartRobotCarMotorShaper();
+}
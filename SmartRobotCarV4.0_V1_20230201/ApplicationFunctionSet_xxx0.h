@@ -10,6 +10,7 @@
 #define _ApplicationFunctionSet_xxx0_H_
 
 #include <Arduino.h>
+#include "FixedPoint_Q16.h"
 
 class ApplicationFunctionSet
 {
@@ -27,7 +28,10 @@ public:
   void ApplicationFunctionSet_KeyCommand(void);         //Mode Switch Button
   void ApplicationFunctionSet_SensorDataUpdate(void);   //Sensor Data Update
   void ApplicationFunctionSet_SerialPortDataAnalysis(void);
+  void ApplicationFunctionSet_SerialPortPrint(const char *Text); //Diagnostics through the TX ring (dropped when it is full)
   void ApplicationFunctionSet_IRrecv(void);
+  void ApplicationFunctionSet_ModeDispatch(void);       //Run the active mode only
+  void ApplicationFunctionSet_TrackingCalibration(void); //Line sensor calibration sweep
 
 public: /*CMD*/
   void CMD_UltrasoundModuleStatus_xxx0(uint8_t is_get);
@@ -36,19 +40,10 @@ public: /*CMD*/
 
   void CMD_inspect_xxx0(void);
   void CMD_MotorControl_xxx0(void);
-  void CMD_MotorControl_xxx0(uint8_t is_MotorSelection, uint8_t is_MotorDirection, uint8_t is_MotorSpeed);
-  void CMD_CarControlTimeLimit_xxx0(void);
-  void CMD_CarControlTimeLimit_xxx0(uint8_t is_CarDirection, uint8_t is_CarSpeed, uint32_t is_Timer);
-  void CMD_CarControlNoTimeLimit_xxx0(void);
-  void CMD_CarControlNoTimeLimit_xxx0(uint8_t is_CarDirection, uint8_t is_CarSpeed);
   void CMD_MotorControlSpeed_xxx0(void);
-  void CMD_MotorControlSpeed_xxx0(uint8_t is_Speed_L, uint8_t is_Speed_R);
   void CMD_ServoControl_xxx0(void);
   void CMD_VoiceControl_xxx0(uint16_t is_VoiceName, uint32_t is_VoiceTimer);
-  void CMD_LightingControlTimeLimit_xxx0(void);
-  void CMD_LightingControlTimeLimit_xxx0(uint8_t is_LightingSequence, uint8_t is_LightingColorValue_R, uint8_t is_LightingColorValue_G, uint8_t is_LightingColorValue_B, uint32_t is_LightingTimer);
-  void CMD_LightingControlNoTimeLimit_xxx0(void);
-  void CMD_LightingControlNoTimeLimit_xxx0(uint8_t is_LightingSequence, uint8_t is_LightingColorValue_R, uint8_t is_LightingColorValue_G, uint8_t is_LightingColorValue_B);
+  void CMD_Queue_xxx0(void);
   void CMD_LEDCustomExpressionControl_xxx0(void);
   void CMD_ClearAllFunctions_xxx0(void);
   void CMD_LEDNumberDisplayControl_xxx0(uint8_t is_LEDNumber);
@@ -56,7 +51,7 @@ public: /*CMD*/
 
 private:
   /*Sensor Raw Value*/
-  volatile float VoltageData_V;        //Battery Voltage Value
+  volatile q16_t VoltageData_V;        //Battery Voltage Value (V)
   volatile uint16_t UltrasoundData_mm; //Ultrasonic Sensor Value (mm)
   volatile uint16_t UltrasoundData_cm; //Ultrasonic Sensor Value (cm)
   volatile int TrackingData_L;         //Line Tracking Module Value (Left)
@@ -70,19 +65,20 @@ private:
   boolean TrackingDetectionStatus_L = false;
 
 public:
-  boolean Car_LeaveTheGround = true;
+  boolean Car_LeaveTheGround = true;          //false：lifted or tipped over
+  uint8_t Car_LeaveTheGround_Confidence = 0; //0~100：how sure the lift detector is that the car is off the ground
 
   /*Sensor Threshold Setting*/
-  const float VoltageDetection = 7.00;
+  const q16_t VoltageDetection = Q16_FromFloat(7.00);
   const uint8_t ObstacleDetection = 20;
 
-  String CommandSerialNumber;
+  char CommandSerialNumber[16]; //H of the command being answered
   uint8_t Rocker_CarSpeed = 250;
   uint8_t Rocker_temp;
 
 public:
-  uint8_t TrackingDetection_S = 250;
-  uint16_t TrackingDetection_E = 850;
+  uint16_t TrackingDetection_S[3] = {250, 250, 250}; //Per sensor L, M, R：line window start (loaded from the calibration)
+  uint16_t TrackingDetection_E[3] = {850, 850, 850}; //Per sensor L, M, R：line window end
   uint16_t TrackingDetection_V = 950;
 
 public:
@@ -93,24 +89,11 @@ public:
   uint8_t CMD_is_MotorSelection; //motor
   uint8_t CMD_is_MotorDirection;
   uint8_t CMD_is_MotorSpeed;
-  uint32_t CMD_is_MotorTimer;
-
-public:
-  uint8_t CMD_is_CarDirection; //car
-  uint8_t CMD_is_CarSpeed;
-  uint32_t CMD_is_CarTimer;
 
 public:
   uint8_t CMD_is_MotorSpeed_L; //motor
   uint8_t CMD_is_MotorSpeed_R;
 
-public:
-  uint8_t CMD_is_LightingSequence; //Lighting (Left, front, right, back and center)
-  uint8_t CMD_is_LightingColorValue_R;
-  uint8_t CMD_is_LightingColorValue_G;
-  uint8_t CMD_is_LightingColorValue_B;
-  uint32_t CMD_is_LightingTimer;
-
 private:
   uint8_t CMD_is_FastLED_setBrightness = 20;
 };
@@ -70,11 +70,12 @@ void DeviceDriverSet_RBGLED::DeviceDriverSet_RBGLED_Color(uint8_t LED_s, uint8_t
 }
 
 /*Key*/
-uint8_t DeviceDriverSet_Key::keyValue = 0;
+template <class Board>
+uint8_t DeviceDriverSet_Key<Board>::keyValue = 0;
 
+template <class Board>
 static void attachPinChangeInterrupt_GetKeyValue(void)
 {
-  DeviceDriverSet_Key Key;
   static uint32_t keyValue_time = 0;
   static uint8_t keyValue_temp = 0;
   if ((millis() - keyValue_time) > 500)
@@ -85,59 +86,132 @@ static void attachPinChangeInterrupt_GetKeyValue(void)
     {
       keyValue_temp = 0;
     }
-    Key.keyValue = keyValue_temp;
+    DeviceDriverSet_Key<Board>::keyValue = keyValue_temp;
   }
 }
-void DeviceDriverSet_Key::DeviceDriverSet_Key_Init(void)
+template <class Board>
+void DeviceDriverSet_Key<Board>::DeviceDriverSet_Key_Init(void)
 {
-  pinMode(PIN_Key, INPUT_PULLUP);
+  pinMode(Board::PIN_Key, INPUT_PULLUP);
   //attachPinChangeInterrupt(PIN_Key, attachPinChangeInterrupt_GetKeyValue, FALLING);
-  attachInterrupt(0, attachPinChangeInterrupt_GetKeyValue, FALLING);
+  attachInterrupt(digitalPinToInterrupt(Board::PIN_Key), attachPinChangeInterrupt_GetKeyValue<Board>, FALLING);
 }
 
 #if _Test_DeviceDriverSet
-void DeviceDriverSet_Key::DeviceDriverSet_Key_Test(void)
+template <class Board>
+void DeviceDriverSet_Key<Board>::DeviceDriverSet_Key_Test(void)
 {
-  Serial.println(DeviceDriverSet_Key::keyValue);
+  Serial.println(keyValue);
 }
 #endif
 
-void DeviceDriverSet_Key::DeviceDriverSet_key_Get(uint8_t *get_keyValue)
+template <class Board>
+void DeviceDriverSet_Key<Board>::DeviceDriverSet_key_Get(uint8_t *get_keyValue)
 {
   *get_keyValue = keyValue;
 }
 
+/*
+  ADC background scan：the ADC interrupt converts A0~A3 in turn (single conversions at 125 kHz ADC clock, 104 us each,
+  one scan about 0.42 ms) into the back half of a double buffer and flips it to the front when the scan is complete.
+  Readers copy the front half, so the values they get always come from one scan.
+  analogRead() must not be used on the scanned pins while the scan runs.
+*/
+static volatile uint16_t ADC_Snapshot[2][ADC_Channels];
+static volatile uint8_t ADC_Front = 0;
+static volatile uint16_t ADC_Sequence = 0;
+static uint8_t ADC_Channel = 0;
+
+ISR(ADC_vect)
+{
+  ADC_Snapshot[ADC_Front ^ 1][ADC_Channel] = ADC;
+  if (++ADC_Channel == ADC_Channels)
+  {
+    ADC_Channel = 0;
+    ADC_Front ^= 1;
+    ADC_Sequence++;
+  }
+  ADMUX = _BV(REFS0) | ADC_Channel; //AVcc reference, as analogRead()
+  ADCSRA |= _BV(ADSC);
+}
+void DeviceDriverSet_ADC::DeviceDriverSet_ADC_Init(void)
+{
+  DIDR0 |= (1 << ADC_Channels) - 1; //Digital input buffers off on the scanned pins
+  ADC_Channel = 0;
+  ADMUX = _BV(REFS0) | ADC_Channel;
+  ADCSRA = _BV(ADEN) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0) | _BV(ADSC);
+  uint16_t Value[ADC_Channels];
+  while (DeviceDriverSet_ADC_Get(Value) == 0) //Wait for the first complete scan
+  {
+  }
+}
+uint16_t DeviceDriverSet_ADC::DeviceDriverSet_ADC_Get(uint16_t *Value)
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  for (uint8_t i = 0; i < ADC_Channels; i++)
+  {
+    Value[i] = ADC_Snapshot[ADC_Front][i];
+  }
+  uint16_t sequence = ADC_Sequence;
+  SREG = oldSREG;
+  return sequence;
+}
+
 /*ITR20001 Detection*/
-bool DeviceDriverSet_ITR20001::DeviceDriverSet_ITR20001_Init(void)
+template <class Board>
+bool DeviceDriverSet_ITR20001<Board>::DeviceDriverSet_ITR20001_Init(void)
 {
-  pinMode(PIN_ITR20001xxxL, INPUT);
-  pinMode(PIN_ITR20001xxxM, INPUT);
-  pinMode(PIN_ITR20001xxxR, INPUT);
+  pinMode(Board::PIN_ITR20001xxxL, INPUT);
+  pinMode(Board::PIN_ITR20001xxxM, INPUT);
+  pinMode(Board::PIN_ITR20001xxxR, INPUT);
   return false;
 }
-int DeviceDriverSet_ITR20001::DeviceDriverSet_ITR20001_getAnaloguexxx_L(void)
+template <class Board>
+uint16_t DeviceDriverSet_ITR20001<Board>::DeviceDriverSet_ITR20001_Get(int *L, int *M, int *R)
+{
+  uint16_t Value[ADC_Channels];
+  uint16_t sequence = DeviceDriverSet_ADC::DeviceDriverSet_ADC_Get(Value);
+  *L = Value[Channel_L];
+  *M = Value[Channel_M];
+  *R = Value[Channel_R];
+  return sequence;
+}
+template <class Board>
+int DeviceDriverSet_ITR20001<Board>::DeviceDriverSet_ITR20001_getAnaloguexxx_L(void)
 {
-  return analogRead(PIN_ITR20001xxxL);
+  uint16_t Value[ADC_Channels];
+  DeviceDriverSet_ADC::DeviceDriverSet_ADC_Get(Value);
+  return Value[Channel_L];
 }
-int DeviceDriverSet_ITR20001::DeviceDriverSet_ITR20001_getAnaloguexxx_M(void)
+template <class Board>
+int DeviceDriverSet_ITR20001<Board>::DeviceDriverSet_ITR20001_getAnaloguexxx_M(void)
 {
-  return analogRead(PIN_ITR20001xxxM);
+  uint16_t Value[ADC_Channels];
+  DeviceDriverSet_ADC::DeviceDriverSet_ADC_Get(Value);
+  return Value[Channel_M];
 }
-int DeviceDriverSet_ITR20001::DeviceDriverSet_ITR20001_getAnaloguexxx_R(void)
+template <class Board>
+int DeviceDriverSet_ITR20001<Board>::DeviceDriverSet_ITR20001_getAnaloguexxx_R(void)
 {
-  return analogRead(PIN_ITR20001xxxR);
+  uint16_t Value[ADC_Channels];
+  DeviceDriverSet_ADC::DeviceDriverSet_ADC_Get(Value);
+  return Value[Channel_R];
 }
 #if _Test_DeviceDriverSet
-void DeviceDriverSet_ITR20001::DeviceDriverSet_ITR20001_Test(void)
+template <class Board>
+void DeviceDriverSet_ITR20001<Board>::DeviceDriverSet_ITR20001_Test(void)
 {
+  int L, M, R;
+  DeviceDriverSet_ITR20001_Get(&L, &M, &R);
   Serial.print("\tL=");
-  Serial.print(analogRead(PIN_ITR20001xxxL));
+  Serial.print(L);
 
   Serial.print("\tM=");
-  Serial.print(analogRead(PIN_ITR20001xxxM));
+  Serial.print(M);
 
   Serial.print("\tR=");
-  Serial.println(analogRead(PIN_ITR20001xxxR));
+  Serial.println(R);
 }
 #endif
 
@@ -147,11 +221,12 @@ void DeviceDriverSet_Voltage::DeviceDriverSet_Voltage_Init(void)
   pinMode(PIN_Voltage, INPUT);
   //analogReference(INTERNAL);
 }
-float DeviceDriverSet_Voltage::DeviceDriverSet_Voltage_getAnalogue(void)
+q16_t DeviceDriverSet_Voltage::DeviceDriverSet_Voltage_getAnalogue(void)
 {
+  uint16_t Value[ADC_Channels];
+  DeviceDriverSet_ADC::DeviceDriverSet_ADC_Get(Value);
   //float Voltage = ((analogRead(PIN_Voltage) * 5.00 / 1024) * 7.67); //7.66666=((10 + 1.50) / 1.50)
-  float Voltage = (analogRead(PIN_Voltage) * 0.0375);
-  Voltage = Voltage + (Voltage * 0.08); //Compensation 8%
+  q16_t Voltage = Voltage_Scale * Value[PIN_Voltage - A0]; //≤ 1023 steps：no overflow
   //return (analogRead(PIN_Voltage) * 5.00 / 1024) * ((10 + 1.50) / 1.50); //Read voltage value
   return Voltage;
 }
@@ -159,155 +234,313 @@ float DeviceDriverSet_Voltage::DeviceDriverSet_Voltage_getAnalogue(void)
 #if _Test_DeviceDriverSet
 void DeviceDriverSet_Voltage::DeviceDriverSet_Voltage_Test(void)
 {
+  uint16_t Value[ADC_Channels];
+  DeviceDriverSet_ADC::DeviceDriverSet_ADC_Get(Value);
   //float Voltage = ((analogRead(PIN_Voltage) * 5.00 / 1024) * 7.67); //7.66666=((10 + 1.50) / 1.50)
-  float Voltage = (analogRead(PIN_Voltage) * 0.0375); //7.66666=((10 + 1.50) / 1.50)
-  Voltage = Voltage + (Voltage * 0.08);               //Compensation 8%
+  q16_t Voltage = Voltage_Scale * Value[PIN_Voltage - A0];
   //Serial.println(analogRead(PIN_Voltage) * 4.97 / 1024);
-  Serial.println(Voltage);
+  Serial.println(Q16_ToFloat(Voltage));
 }
 #endif
 /*Motor control*/
-void DeviceDriverSet_Motor::DeviceDriverSet_Motor_Init(void)
+/*
+  TB6612 outputs written straight to the port and Timer0 registers through DeviceDriverSet_Pin
+  (digitalWrite/analogWrite look the pin up in flash on every call).
+*/
+template <class Board>
+void DeviceDriverSet_Motor<Board>::DeviceDriverSet_Motor_Init(void)
 {
-  pinMode(PIN_Motor_PWMA, OUTPUT);
-  pinMode(PIN_Motor_PWMB, OUTPUT);
-  pinMode(PIN_Motor_AIN_1, OUTPUT);
-  pinMode(PIN_Motor_BIN_1, OUTPUT);
-  pinMode(PIN_Motor_STBY, OUTPUT);
+  pinMode(Board::PIN_Motor_PWMA, OUTPUT);
+  pinMode(Board::PIN_Motor_PWMB, OUTPUT);
+  pinMode(Board::PIN_Motor_AIN_1, OUTPUT);
+  pinMode(Board::PIN_Motor_BIN_1, OUTPUT);
+  pinMode(Board::PIN_Motor_STBY, OUTPUT);
+  //Once through the Arduino calls：every compare output starts disconnected and the cache matches the pins
+  digitalWrite(Board::PIN_Motor_PWMA, LOW);
+  digitalWrite(Board::PIN_Motor_PWMB, LOW);
+  digitalWrite(Board::PIN_Motor_AIN_1, LOW);
+  digitalWrite(Board::PIN_Motor_BIN_1, LOW);
+  digitalWrite(Board::PIN_Motor_STBY, LOW);
+  Motor_STBY = false;
+  Motor_AIN = false;
+  Motor_BIN = false;
+  Motor_PWMA = 0;
+  Motor_PWMB = 0;
 }
 
 #if _Test_DeviceDriverSet
-void DeviceDriverSet_Motor::DeviceDriverSet_Motor_Test(void)
+template <class Board>
+void DeviceDriverSet_Motor<Board>::DeviceDriverSet_Motor_Test(void)
 {
   //A...Right
   //B...Left
-  digitalWrite(PIN_Motor_STBY, HIGH);
+  digitalWrite(Board::PIN_Motor_STBY, HIGH);
 
-  digitalWrite(PIN_Motor_AIN_1, HIGH);
-  analogWrite(PIN_Motor_PWMA, 100);
-  digitalWrite(PIN_Motor_BIN_1, HIGH);
-  analogWrite(PIN_Motor_PWMB, 100);
+  digitalWrite(Board::PIN_Motor_AIN_1, HIGH);
+  analogWrite(Board::PIN_Motor_PWMA, 100);
+  digitalWrite(Board::PIN_Motor_BIN_1, HIGH);
+  analogWrite(Board::PIN_Motor_PWMB, 100);
   delay_xxx(1000);
 
-  digitalWrite(PIN_Motor_STBY, LOW);
+  digitalWrite(Board::PIN_Motor_STBY, LOW);
   delay_xxx(1000);
-  digitalWrite(PIN_Motor_STBY, HIGH);
-  digitalWrite(PIN_Motor_AIN_1, LOW);
-  analogWrite(PIN_Motor_PWMA, 100);
-  digitalWrite(PIN_Motor_BIN_1, LOW);
-  analogWrite(PIN_Motor_PWMB, 100);
+  digitalWrite(Board::PIN_Motor_STBY, HIGH);
+  digitalWrite(Board::PIN_Motor_AIN_1, LOW);
+  analogWrite(Board::PIN_Motor_PWMA, 100);
+  digitalWrite(Board::PIN_Motor_BIN_1, LOW);
+  analogWrite(Board::PIN_Motor_PWMB, 100);
 
   delay_xxx(1000);
 }
 #endif
 
+/*Write only the TB6612 outputs that differ from the last written state (STBY last：a stopped car never sees a stale duty)*/
+template <class Board>
+void DeviceDriverSet_Motor<Board>::DeviceDriverSet_Motor_Output(bool STBY, bool AIN, uint8_t PWMA, bool BIN, uint8_t PWMB)
+{
+  if (AIN != Motor_AIN)
+  {
+    AIN_Pin::Write(AIN);
+    Motor_AIN = AIN;
+  }
+  if (PWMA != Motor_PWMA)
+  {
+    PWMA_Pin::Duty(PWMA);
+    Motor_PWMA = PWMA;
+  }
+  if (BIN != Motor_BIN)
+  {
+    BIN_Pin::Write(BIN);
+    Motor_BIN = BIN;
+  }
+  if (PWMB != Motor_PWMB)
+  {
+    PWMB_Pin::Duty(PWMB);
+    Motor_PWMB = PWMB;
+  }
+  if (STBY != Motor_STBY)
+  {
+    STBY_Pin::Write(STBY);
+    Motor_STBY = STBY;
+  }
+}
+
 /*
  Motor_control：AB / movement direction and speed
 */
-void DeviceDriverSet_Motor::DeviceDriverSet_Motor_control(boolean direction_A, uint8_t speed_A, //Group A motor parameters
+template <class Board>
+void DeviceDriverSet_Motor<Board>::DeviceDriverSet_Motor_control(boolean direction_A, uint8_t speed_A, //Group A motor parameters
                                                           boolean direction_B, uint8_t speed_B, //Group B motor parameters
                                                           boolean controlED                     //AB enable setting (true)
                                                           )                                     //Motor control
 {
-
   if (controlED == control_enable) //Enable motot control？
   {
-    digitalWrite(PIN_Motor_STBY, HIGH);
-    { //A...Right
-
-      switch (direction_A) //movement direction control
-      {
-      case direction_just:
-        digitalWrite(PIN_Motor_AIN_1, HIGH);
-        analogWrite(PIN_Motor_PWMA, speed_A);
-        break;
-      case direction_back:
-
-        digitalWrite(PIN_Motor_AIN_1, LOW);
-        analogWrite(PIN_Motor_PWMA, speed_A);
-        break;
-      case direction_void:
-        analogWrite(PIN_Motor_PWMA, 0);
-        digitalWrite(PIN_Motor_STBY, LOW);
-        break;
-      default:
-        analogWrite(PIN_Motor_PWMA, 0);
-        digitalWrite(PIN_Motor_STBY, LOW);
-        break;
-      }
-    }
-
-    { //B...Left
-      switch (direction_B)
-      {
-      case direction_just:
-        digitalWrite(PIN_Motor_BIN_1, HIGH);
-
-        analogWrite(PIN_Motor_PWMB, speed_B);
-        break;
-      case direction_back:
-        digitalWrite(PIN_Motor_BIN_1, LOW);
-        analogWrite(PIN_Motor_PWMB, speed_B);
-        break;
-      case direction_void:
-        analogWrite(PIN_Motor_PWMB, 0);
-        digitalWrite(PIN_Motor_STBY, LOW);
-        break;
-      default:
-        analogWrite(PIN_Motor_PWMB, 0);
-        digitalWrite(PIN_Motor_STBY, LOW);
-        break;
-      }
+    /*direction_void arrives as true (direction_just) in the boolean parameters：a void side runs forward at its speed*/
+    if (speed_A > 0 || speed_B > 0)
+    {
+      Motor_RunMillis = millis();
     }
+    bool AIN = (direction_A == direction_just) ? HIGH : LOW; //A...Right
+    bool BIN = (direction_B == direction_just) ? HIGH : LOW; //B...Left
+    DeviceDriverSet_Motor_Output(HIGH, AIN, speed_A, BIN, speed_B);
   }
   else
   {
-    digitalWrite(PIN_Motor_STBY, LOW);
+    DeviceDriverSet_Motor_Output(LOW, Motor_AIN, Motor_PWMA, Motor_BIN, Motor_PWMB);
     return;
   }
 }
 
+#if _Test_DeviceDriverSet
+/*The previous Arduino-call path：reference for DeviceDriverSet_Motor_Benchmark*/
+template <class Board>
+static void DeviceDriverSet_Motor_controlArduino(boolean direction_A, uint8_t speed_A, boolean direction_B, uint8_t speed_B)
+{
+  digitalWrite(Board::PIN_Motor_STBY, HIGH);
+  digitalWrite(Board::PIN_Motor_AIN_1, (direction_A == direction_just) ? HIGH : LOW);
+  analogWrite(Board::PIN_Motor_PWMA, speed_A);
+  digitalWrite(Board::PIN_Motor_BIN_1, (direction_B == direction_just) ? HIGH : LOW);
+  analogWrite(Board::PIN_Motor_PWMB, speed_B);
+}
+/*
+  CPU cycles per motor control call (loop overhead included), averaged over 1000 calls：
+  the same command repeated (tracking / rocker steady state) and two commands alternating (every output changes).
+  Duties stay below the stall threshold so the wheels do not turn；the pins are re-initialised afterwards.
+*/
+template <class Board>
+void DeviceDriverSet_Motor<Board>::DeviceDriverSet_Motor_Benchmark(void)
+{
+  const uint16_t calls = 1000;
+  unsigned long t[4];
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < calls; i++)
+  {
+    DeviceDriverSet_Motor_controlArduino<Board>(direction_just, 20, direction_just, 20);
+  }
+  t[0] = micros() - start;
+  start = micros();
+  for (uint16_t i = 0; i < calls; i++)
+  {
+    DeviceDriverSet_Motor_controlArduino<Board>((i & 1) ? direction_just : direction_back, (i & 1) ? 20 : 40,
+                                                (i & 1) ? direction_back : direction_just, (i & 1) ? 40 : 20);
+  }
+  t[1] = micros() - start;
+  DeviceDriverSet_Motor_Init();
+  start = micros();
+  for (uint16_t i = 0; i < calls; i++)
+  {
+    DeviceDriverSet_Motor_control(direction_just, 20, direction_just, 20, control_enable);
+  }
+  t[2] = micros() - start;
+  start = micros();
+  for (uint16_t i = 0; i < calls; i++)
+  {
+    DeviceDriverSet_Motor_control((i & 1) ? direction_just : direction_back, (i & 1) ? 20 : 40,
+                                  (i & 1) ? direction_back : direction_just, (i & 1) ? 40 : 20, control_enable);
+  }
+  t[3] = micros() - start;
+  DeviceDriverSet_Motor_Init();
+  Serial.print("Motor_control cycles, Arduino repeated/alternating: ");
+  Serial.print(t[0] * clockCyclesPerMicrosecond() / calls);
+  Serial.print("/");
+  Serial.println(t[1] * clockCyclesPerMicrosecond() / calls);
+  Serial.print("Motor_control cycles, direct repeated/alternating: ");
+  Serial.print(t[2] * clockCyclesPerMicrosecond() / calls);
+  Serial.print("/");
+  Serial.println(t[3] * clockCyclesPerMicrosecond() / calls);
+}
+#endif
+
 /*ULTRASONIC*/
 //#include <NewPing.h>
 // NewPing sonar(TRIGGER_PIN, ECHO_PIN, MAX_DISTANCE); // NewPing setup of pins and maximum distance.
-void DeviceDriverSet_ULTRASONIC::DeviceDriverSet_ULTRASONIC_Init(void)
+/*
+  Non-blocking ranging：DeviceDriverSet_ULTRASONIC_Update() sends the trigger pulse, the pin change interrupt on
+  ECHO_PIN timestamps both echo edges, and the next Update() converts the echo width into the published distance.
+  No echo within the round trip time of MAX_DISTANCE is published as ULTRASONIC_Distance_Max.
+*/
+enum ULTRASONIC_EchoStatus
+{
+  ULTRASONIC_Echo_Idle,    /*no ping in flight*/
+  ULTRASONIC_Echo_Armed,   /*trigger sent, waiting for the rising edge*/
+  ULTRASONIC_Echo_Rising,  /*rising edge seen, waiting for the falling edge*/
+  ULTRASONIC_Echo_Complete /*echo width available*/
+};
+static volatile uint8_t ULTRASONIC_Echo = ULTRASONIC_Echo_Idle;
+static volatile unsigned long ULTRASONIC_EchoRise;
+static volatile unsigned long ULTRASONIC_EchoWidth;
+
+ISR(PCINT0_vect)
+{
+  if (DeviceDriverSet_Pin<DeviceDriverSet_Board::ECHO_PIN>::Read()) //ECHO_PIN of the board built for
+  {
+    if (ULTRASONIC_Echo == ULTRASONIC_Echo_Armed)
+    {
+      ULTRASONIC_EchoRise = micros();
+      ULTRASONIC_Echo = ULTRASONIC_Echo_Rising;
+    }
+  }
+  else if (ULTRASONIC_Echo == ULTRASONIC_Echo_Rising)
+  {
+    ULTRASONIC_EchoWidth = micros() - ULTRASONIC_EchoRise;
+    ULTRASONIC_Echo = ULTRASONIC_Echo_Complete;
+  }
+}
+
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Init(void)
 {
-  pinMode(ECHO_PIN, INPUT); //Ultrasonic module initialization
-  pinMode(TRIG_PIN, OUTPUT);
+  pinMode(Board::ECHO_PIN, INPUT); //Ultrasonic module initialization
+  pinMode(Board::TRIG_PIN, OUTPUT);
+  digitalWrite(Board::TRIG_PIN, LOW);
+  PCMSK0 |= _BV(Echo_Pin::Bit); //ECHO_PIN pin change interrupt (PCINT0~5 = PB0~5)
+  PCICR |= _BV(PCIE0);
 }
-void DeviceDriverSet_ULTRASONIC::DeviceDriverSet_ULTRASONIC_Get(uint16_t *ULTRASONIC_Get /*out*/)
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_SetPingPeriod(uint16_t PingPeriod_ms)
 {
-  unsigned int tempda_x = 0;
-  digitalWrite(TRIG_PIN, LOW);
-  delayMicroseconds(2);
-  digitalWrite(TRIG_PIN, HIGH);
-  delayMicroseconds(10);
-  digitalWrite(TRIG_PIN, LOW);
-  tempda_x = ((unsigned int)pulseIn(ECHO_PIN, HIGH) / 58);
-  // *ULTRASONIC_Get = tempda_x;
+  if (PingPeriod_ms < ULTRASONIC_PingPeriod_Min)
+  {
+    PingPeriod_ms = ULTRASONIC_PingPeriod_Min;
+  }
+  PingPeriod = PingPeriod_ms;
+}
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Update(void)
+{
+  if (Status == ULTRASONIC_Echo_Idle)
+  {
+    //The echo line of the HC-SR04 stays high for a while when nothing echoes：do not trigger until it falls
+    if ((millis() - Trigger_millis) >= PingPeriod && !Echo_Pin::Read())
+    {
+      Trigger_millis = millis();
+      ULTRASONIC_Echo = ULTRASONIC_Echo_Armed;
+      Trig_Pin::Write(HIGH);
+      delayMicroseconds(10);
+      Trig_Pin::Write(LOW);
+      Trigger_micros = micros();
+      Status = ULTRASONIC_Echo_Armed;
+    }
+    return;
+  }
 
-  if (tempda_x > 150)
+  uint16_t tempda_x;
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t Echo = ULTRASONIC_Echo;
+  unsigned long EchoWidth = ULTRASONIC_EchoWidth;
+  SREG = sreg;
+  if (Echo == ULTRASONIC_Echo_Complete)
   {
-    *ULTRASONIC_Get = 150;
+    tempda_x = (unsigned int)(EchoWidth / US_ROUNDTRIP_CM);
+  }
+  else if ((micros() - Trigger_micros) > (ULTRASONIC_EchoTimeout_us + 2000)) //Echo out of range (2ms：trigger to burst latency)
+  {
+    tempda_x = ULTRASONIC_Distance_Max;
   }
   else
   {
-    *ULTRASONIC_Get = tempda_x;
+    return;
   }
-  // sonar.ping() / US_ROUNDTRIP_CM; // Send ping, get ping time in microseconds (uS).
+  ULTRASONIC_Echo = ULTRASONIC_Echo_Idle;
+  Status = ULTRASONIC_Echo_Idle;
+  if (tempda_x > ULTRASONIC_Distance_Max)
+  {
+    tempda_x = ULTRASONIC_Distance_Max;
+  }
+  Distance_cm = tempda_x;
+  Distance_millis = Trigger_millis; //Time of the ping, not of its evaluation
+}
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Get(uint16_t *ULTRASONIC_Get /*out*/)
+{
+  *ULTRASONIC_Get = Distance_cm;
+}
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Get(uint16_t *ULTRASONIC_Get /*out*/, unsigned long *ULTRASONIC_Millis /*out*/)
+{
+  *ULTRASONIC_Get = Distance_cm;
+  *ULTRASONIC_Millis = Distance_millis;
+}
+template <class Board>
+unsigned long DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Age(void)
+{
+  return millis() - Distance_millis;
 }
 
 #if _Test_DeviceDriverSet
-void DeviceDriverSet_ULTRASONIC::DeviceDriverSet_ULTRASONIC_Test(void)
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Test(void)
 {
 
   unsigned int tempda = 0;
-  digitalWrite(TRIG_PIN, LOW);
+  digitalWrite(Board::TRIG_PIN, LOW);
   delayMicroseconds(2);
-  digitalWrite(TRIG_PIN, HIGH);
+  digitalWrite(Board::TRIG_PIN, HIGH);
   delayMicroseconds(10);
-  digitalWrite(TRIG_PIN, LOW);
-  tempda = ((unsigned int)pulseIn(ECHO_PIN, HIGH) / 58);
+  digitalWrite(Board::TRIG_PIN, LOW);
+  tempda = ((unsigned int)pulseIn(Board::ECHO_PIN, HIGH) / 58);
 
   // if (tempda_x > 50)
   // {
@@ -326,68 +559,135 @@ void DeviceDriverSet_ULTRASONIC::DeviceDriverSet_ULTRASONIC_Test(void)
 
 /*Servo*/
 
-Servo myservo; // create servo object to control a servo
-void DeviceDriverSet_Servo::DeviceDriverSet_Servo_Init(unsigned int Position_angle)
+ISR(TIMER1_OVF_vect) //Start of the period：Servo_y pulse on
 {
-  myservo.attach(PIN_Servo_z, 500, 2400); //500: 0 degree  2400: 180 degree
-  myservo.attach(PIN_Servo_z);
-  myservo.write(Position_angle); //sets the servo position according to the 90（middle）
-  delay_xxx(500);
-
-  myservo.attach(PIN_Servo_y, 500, 2400); //500: 0 degree  2400: 180 degree
-  myservo.attach(PIN_Servo_y);
-  myservo.write(Position_angle); //sets the servo position according to the 90（middle）
-  delay_xxx(500);
-  myservo.detach();
+  DeviceDriverSet_Pin<DeviceDriverSet_Board::PIN_Servo_y>::Write(HIGH);
+}
+ISR(TIMER1_COMPA_vect) //OCR1A：Servo_y pulse off
+{
+  DeviceDriverSet_Pin<DeviceDriverSet_Board::PIN_Servo_y>::Write(LOW);
+}
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_Pulse(uint8_t Servo_xxx, uint8_t Position_angle)
+{
+  uint16_t Pulse = 2 * (Servo_Pulse_Min + (uint32_t)min(Position_angle, (uint8_t)180) * (Servo_Pulse_Max - Servo_Pulse_Min) / 180);
+  if (Servo_xxx == Servo_z)
+  {
+    OCR1B = Pulse; //Double buffered：taken at the end of the period, a pulse is never cut short
+  }
+  else
+  {
+    OCR1A = Pulse;
+  }
+}
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_Init(unsigned int Position_angle)
+{
+  pinMode(Board::PIN_Servo_z, OUTPUT);
+  pinMode(Board::PIN_Servo_y, OUTPUT);
+  digitalWrite(Board::PIN_Servo_y, LOW);
+  TCCR1A = 0; //Timer1 stopped in normal mode while it is set up：the compare registers are written directly
+  TCCR1B = 0;
+  TCNT1 = 0;
+  ICR1 = 2 * Servo_Period - 1;
+  DeviceDriverSet_Servo_Pulse(Servo_z, Position_angle);
+  DeviceDriverSet_Servo_Pulse(Servo_y, Position_angle);
+  TCCR1A = _BV(COM1B1) | _BV(WGM11);             //OC1B：set at BOTTOM, cleared on compare match
+  TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS11); //Fast PWM TOP ICR1 (mode 14), clk/8
+  TIMSK1 = _BV(TOIE1) | _BV(OCIE1A);
+  delay_xxx(500); //Both servos to the start position
+  Servo_Position[Servo_z] = Servo_Target[Servo_z] = Position_angle;
+  Servo_Position[Servo_y] = Servo_Target[Servo_y] = Position_angle;
 }
 #if _Test_DeviceDriverSet
-void DeviceDriverSet_Servo::DeviceDriverSet_Servo_Test(void)
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_Test(void)
 {
   for (;;)
   {
-    myservo.attach(PIN_Servo_z);
-    myservo.write(180);
+    DeviceDriverSet_Servo_Pulse(Servo_z, 180);
+    DeviceDriverSet_Servo_Pulse(Servo_y, 180);
     delay_xxx(500);
-    myservo.write(0);
+    DeviceDriverSet_Servo_Pulse(Servo_z, 0);
+    DeviceDriverSet_Servo_Pulse(Servo_y, 0);
     delay_xxx(500);
   }
-
-  // for (uint8_t i = 0; i < 6; i++)
-  // {
-  //   myservo.write(30 * i);
-  //   delay(500);
-  // }
-  // for (uint8_t i = 6; i > 0; i--)
-  // {
-  //   myservo.write(30 * i);
-  //   delay(500);
-  // }
-
-  // myservo.attach(PIN_Servo_y);
-
-  // for (uint8_t i = 0; i < 6; i++)
-  // {
-  //   myservo.write(30 * i);
-  //   delay(500);
-  // }
-  // for (uint8_t i = 6; i > 0; i--)
-  // {
-  //   myservo.write(30 * i);
-  //   delay(500);
-  // }
 }
 #endif
 
+/*
+  Servo moves：a move writes the pulse width at once and records the estimated arrival time,
+  DeviceDriverSet_Servo_Update() reports the servo in position once it has passed. Each servo moves on its own.
+*/
 /*0.17sec/60degree(4.8v)*/
-void DeviceDriverSet_Servo::DeviceDriverSet_Servo_control(unsigned int Position_angle)
+static unsigned long Servo_SlewTime(uint8_t Position_from, uint8_t Position_to)
 {
-  myservo.attach(PIN_Servo_z);
-  myservo.write(Position_angle);
-  delay_xxx(450);
-  myservo.detach();
+  uint16_t Angle = (Position_from > Position_to) ? (Position_from - Position_to) : (Position_to - Position_from);
+  return (Angle * 17UL) / 6 + Servo_Settle_ms;
+}
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_move(uint8_t Servo_xxx, uint8_t Position_angle)
+{
+  if (Servo_Moving & (1 << Servo_xxx)) //Retarget the running move：it may still be anywhere between position and target
+  {
+    unsigned long Slew = max(Servo_SlewTime(Servo_Position[Servo_xxx], Position_angle), Servo_SlewTime(Servo_Target[Servo_xxx], Position_angle));
+    Servo_Arrival_millis[Servo_xxx] = millis() + Slew;
+  }
+  else if (Servo_Position[Servo_xxx] != Position_angle)
+  {
+    Servo_Arrival_millis[Servo_xxx] = millis() + Servo_SlewTime(Servo_Position[Servo_xxx], Position_angle);
+    Servo_Moving |= (1 << Servo_xxx);
+  }
+  else
+  {
+    return;
+  }
+  Servo_Target[Servo_xxx] = Position_angle;
+  DeviceDriverSet_Servo_Pulse(Servo_xxx, Position_angle);
+}
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_Update(void)
+{
+  for (uint8_t Servo_xxx = Servo_z; Servo_xxx <= Servo_y; Servo_xxx++)
+  {
+    if ((Servo_Moving & (1 << Servo_xxx)) && (long)(millis() - Servo_Arrival_millis[Servo_xxx]) >= 0)
+    {
+      Servo_Position[Servo_xxx] = Servo_Target[Servo_xxx];
+      Servo_Moving &= ~(1 << Servo_xxx);
+      Servo_Event |= (1 << Servo_xxx);
+    }
+  }
+}
+template <class Board>
+bool DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_InPosition(uint8_t Servo)
+{
+  for (uint8_t Servo_xxx = Servo_z; Servo_xxx <= Servo_y; Servo_xxx++)
+  {
+    if (Servo & (1 << Servo_xxx))
+    {
+      if (Servo_Moving & (1 << Servo_xxx))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+template <class Board>
+uint8_t DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_GetEvent(void)
+{
+  uint8_t Event = Servo_Event;
+  Servo_Event = 0;
+  return Event;
+}
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_control(unsigned int Position_angle)
+{
+  DeviceDriverSet_Servo_move(Servo_z, Position_angle);
 }
 //Servo motor control:Servo motor number and position angle
-void DeviceDriverSet_Servo::DeviceDriverSet_Servo_controls(uint8_t Servo, unsigned int Position_angle)
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_controls(uint8_t Servo, unsigned int Position_angle)
 {
   if (Servo == 1 || Servo == 3) //Servo_z
   {
@@ -399,9 +699,7 @@ void DeviceDriverSet_Servo::DeviceDriverSet_Servo_controls(uint8_t Servo, unsign
     {
       Position_angle = 17;
     }
-    myservo.attach(PIN_Servo_z);
-    myservo.write(10 * Position_angle);
-    delay_xxx(500);
+    DeviceDriverSet_Servo_move(Servo_z, 10 * Position_angle);
   }
   if (Servo == 2 || Servo == 3) //Servo_y
   {
@@ -414,11 +712,8 @@ void DeviceDriverSet_Servo::DeviceDriverSet_Servo_controls(uint8_t Servo, unsign
     {
       Position_angle = 11;
     }
-    myservo.attach(PIN_Servo_y);
-    myservo.write(10 * Position_angle);
-    delay_xxx(500);
+    DeviceDriverSet_Servo_move(Servo_y, 10 * Position_angle);
   }
-  myservo.detach();
 }
 
 /*IRrecv*/
@@ -518,3 +813,10 @@ void DeviceDriverSet_IRrecv::DeviceDriverSet_IRrecv_Test(void)
   }
 }
 #endif
+
+/*Only the board selected by DeviceDriverSet_Board is compiled：the ISRs above are bound to its pins*/
+template class DeviceDriverSet_Key<DeviceDriverSet_Board>;
+template class DeviceDriverSet_ITR20001<DeviceDriverSet_Board>;
+template class DeviceDriverSet_Motor<DeviceDriverSet_Board>;
+template class DeviceDriverSet_ULTRASONIC<DeviceDriverSet_Board>;
+template class DeviceDriverSet_Servo<DeviceDriverSet_Board>;
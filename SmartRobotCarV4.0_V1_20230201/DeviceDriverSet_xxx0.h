@@ -11,6 +11,102 @@
 
 #define _Test_DeviceDriverSet 0
 
+/*
+  Board revisions：a descriptor is the pin map (Arduino pin numbers) of one car revision, and the Key, ITR20001, Motor,
+  ULTRASONIC and Servo drivers are templates on it, so the pins fold into port, bit and ADC channel constants at compile
+  time. The car is built for DeviceDriverSet_Board.
+*/
+#include <Arduino.h>
+struct DeviceDriverSet_Board03
+{
+  static constexpr uint8_t PIN_Key = 2;
+  static constexpr uint8_t PIN_ITR20001xxxL = A0;
+  static constexpr uint8_t PIN_ITR20001xxxM = A1;
+  static constexpr uint8_t PIN_ITR20001xxxR = A2;
+  static constexpr uint8_t PIN_Motor_PWMA = 5;
+  static constexpr uint8_t PIN_Motor_PWMB = 6;
+  static constexpr uint8_t PIN_Motor_BIN_1 = 7;
+  static constexpr uint8_t PIN_Motor_AIN_1 = 9;
+  static constexpr uint8_t PIN_Motor_STBY = 8;
+  static constexpr uint8_t TRIG_PIN = 13;
+  static constexpr uint8_t ECHO_PIN = 12;
+  static constexpr uint8_t PIN_Servo_z = 10;
+  static constexpr uint8_t PIN_Servo_y = 11;
+};
+struct DeviceDriverSet_Board04
+{
+  static constexpr uint8_t PIN_Key = 2;
+  static constexpr uint8_t PIN_ITR20001xxxL = A2;
+  static constexpr uint8_t PIN_ITR20001xxxM = A1;
+  static constexpr uint8_t PIN_ITR20001xxxR = A0;
+  static constexpr uint8_t PIN_Motor_PWMA = 5;
+  static constexpr uint8_t PIN_Motor_PWMB = 6;
+  static constexpr uint8_t PIN_Motor_BIN_1 = 8;
+  static constexpr uint8_t PIN_Motor_AIN_1 = 7;
+  static constexpr uint8_t PIN_Motor_STBY = 3;
+  static constexpr uint8_t TRIG_PIN = 13;
+  static constexpr uint8_t ECHO_PIN = 12;
+  static constexpr uint8_t PIN_Servo_z = 10;
+  static constexpr uint8_t PIN_Servo_y = 11;
+};
+typedef DeviceDriverSet_Board04 DeviceDriverSet_Board;
+
+/*
+  One ATmega328P pin as constants：D0~D7 = PORTD, D8~D13 = PORTB, A0~A5 = PORTC.
+  Write/Read compile to a single sbi/cbi/sbic on the port；Duty is analogWrite() on the Timer0 pins (D5 OC0B, D6 OC0A)：
+  0 and 255 disconnect the compare output and drive the pin, anything else is fast PWM.
+  Other targets go through the Arduino calls.
+*/
+template <uint8_t Pin>
+struct DeviceDriverSet_Pin
+{
+  static_assert(Pin < 20, "ATmega328P pins are D0~D13 and A0~A5");
+  static constexpr uint8_t Bit = (Pin < 8) ? Pin : ((Pin < 14) ? Pin - 8 : Pin - 14);
+  static constexpr uint8_t Group = (Pin < 8) ? 2 : ((Pin < 14) ? 0 : 1); //Pin change interrupt group (PCINTx_vect)
+  static volatile uint8_t &Port(void) { return (Pin < 8) ? PORTD : ((Pin < 14) ? PORTB : PORTC); }
+  static volatile uint8_t &Input(void) { return (Pin < 8) ? PIND : ((Pin < 14) ? PINB : PINC); }
+#if defined(__AVR_ATmega328P__)
+  static void Write(bool Level)
+  {
+    if (Level)
+    {
+      Port() |= _BV(Bit);
+    }
+    else
+    {
+      Port() &= ~_BV(Bit);
+    }
+  }
+  static bool Read(void) { return Input() & _BV(Bit); }
+  static void Duty(uint8_t Value)
+  {
+    static_assert(Pin == 5 || Pin == 6, "Duty drives the Timer0 compare outputs only");
+    const uint8_t COM = (Pin == 5) ? COM0B1 : COM0A1;
+    if (0 == Value || 255 == Value)
+    {
+      TCCR0A &= ~_BV(COM);
+      Write(Value);
+    }
+    else
+    {
+      if (Pin == 5)
+      {
+        OCR0B = Value;
+      }
+      else
+      {
+        OCR0A = Value;
+      }
+      TCCR0A |= _BV(COM);
+    }
+  }
+#else
+  static void Write(bool Level) { digitalWrite(Pin, Level); }
+  static bool Read(void) { return digitalRead(Pin); }
+  static void Duty(uint8_t Value) { analogWrite(Pin, Value); }
+#endif
+};
+
 /*RBG LED*/
 #include "FastLED.h"
 class DeviceDriverSet_RBGLED
@@ -32,6 +128,7 @@ public:
 };
 
 /*Key Detection*/
+template <class Board>
 class DeviceDriverSet_Key
 {
 public:
@@ -42,17 +139,29 @@ public:
   void DeviceDriverSet_key_Get(uint8_t *get_keyValue);
 
 public:
-#define PIN_Key 2
 #define keyValue_Max 4
 public:
   static uint8_t keyValue;
 };
 
+/*ADC background scan：A0~A3 (ITR20001 R/M/L, Voltage)*/
+class DeviceDriverSet_ADC
+{
+public:
+  void DeviceDriverSet_ADC_Init(void);
+  static uint16_t DeviceDriverSet_ADC_Get(uint16_t *Value /*out[ADC_Channels]*/); //Latest complete scan, returns its sequence number
+
+public:
+#define ADC_Channels 4
+};
+
 /*ITR20001 Detection*/
+template <class Board>
 class DeviceDriverSet_ITR20001
 {
 public:
   bool DeviceDriverSet_ITR20001_Init(void);
+  uint16_t DeviceDriverSet_ITR20001_Get(int *L, int *M, int *R); //All three from one scan, returns its sequence number
   int DeviceDriverSet_ITR20001_getAnaloguexxx_L(void);
   int DeviceDriverSet_ITR20001_getAnaloguexxx_M(void);
   int DeviceDriverSet_ITR20001_getAnaloguexxx_R(void);
@@ -61,53 +170,56 @@ public:
 #endif
 
 private:
-//03
-// #define PIN_ITR20001xxxL A0
-// #define PIN_ITR20001xxxM A1
-// #define PIN_ITR20001xxxR A2
-//04
-#define PIN_ITR20001xxxL A2
-#define PIN_ITR20001xxxM A1
-#define PIN_ITR20001xxxR A0
+  //Index of each sensor in the ADC scan (A0~A3)
+  static constexpr uint8_t Channel_L = Board::PIN_ITR20001xxxL - A0;
+  static constexpr uint8_t Channel_M = Board::PIN_ITR20001xxxM - A0;
+  static constexpr uint8_t Channel_R = Board::PIN_ITR20001xxxR - A0;
+  static_assert(Channel_L < ADC_Channels && Channel_M < ADC_Channels && Channel_R < ADC_Channels, "ITR20001 sensors must be on the pins scanned by DeviceDriverSet_ADC");
 };
 
 /*Voltage Detection*/
+#include "FixedPoint_Q16.h"
 class DeviceDriverSet_Voltage
 {
 public:
   void DeviceDriverSet_Voltage_Init(void);
-  float DeviceDriverSet_Voltage_getAnalogue(void);
+  q16_t DeviceDriverSet_Voltage_getAnalogue(void);
 #if _Test_DeviceDriverSet
   void DeviceDriverSet_Voltage_Test(void);
 #endif
 private:
 #define PIN_Voltage A3
+#define Voltage_Scale Q16_FromFloat(0.0375 * 1.08) //V per ADC step：7.66666=((10 + 1.50) / 1.50), compensation 8%
 };
 
 /*Motor*/
+template <class Board>
 class DeviceDriverSet_Motor
 {
 public:
   void DeviceDriverSet_Motor_Init(void);
 #if _Test_DeviceDriverSet
   void DeviceDriverSet_Motor_Test(void);
+  void DeviceDriverSet_Motor_Benchmark(void);
 #endif
   void DeviceDriverSet_Motor_control(boolean direction_A, uint8_t speed_A, //Group A motor parameters
                                      boolean direction_B, uint8_t speed_B, //Group B motor parameters
                                      boolean controlED                     //AB enable setting (true)
   );                                                                       //motor control
+  unsigned long Motor_RunMillis = 0;                                       //millis() of the last control that drove a motor
 private:
-  // #define PIN_Motor_PWMA 5
-  // #define PIN_Motor_PWMB 6
-  // #define PIN_Motor_STBY 8
-  // #define PIN_Motor_BIN_1 7
-  // #define PIN_Motor_AIN_1 9
-//TB6612
-#define PIN_Motor_PWMA 5
-#define PIN_Motor_PWMB 6
-#define PIN_Motor_BIN_1 8
-#define PIN_Motor_AIN_1 7
-#define PIN_Motor_STBY 3
+  void DeviceDriverSet_Motor_Output(bool STBY, bool AIN, uint8_t PWMA, bool BIN, uint8_t PWMB);
+  /*Output state last written to the TB6612：writes that would not change it are skipped*/
+  bool Motor_STBY = false;
+  bool Motor_AIN = false, Motor_BIN = false;
+  uint8_t Motor_PWMA = 0, Motor_PWMB = 0;
+  //TB6612
+  typedef DeviceDriverSet_Pin<Board::PIN_Motor_PWMA> PWMA_Pin;
+  typedef DeviceDriverSet_Pin<Board::PIN_Motor_PWMB> PWMB_Pin;
+  typedef DeviceDriverSet_Pin<Board::PIN_Motor_AIN_1> AIN_Pin;
+  typedef DeviceDriverSet_Pin<Board::PIN_Motor_BIN_1> BIN_Pin;
+  typedef DeviceDriverSet_Pin<Board::PIN_Motor_STBY> STBY_Pin;
+
 public:
 #define speed_Max 255
 #define direction_just true
@@ -122,6 +234,7 @@ public:
 /*ULTRASONIC*/
 
 //#include <NewPing.h>
+template <class Board>
 class DeviceDriverSet_ULTRASONIC
 {
 public:
@@ -129,28 +242,70 @@ public:
 #if _Test_DeviceDriverSet
   void DeviceDriverSet_ULTRASONIC_Test(void);
 #endif
-  void DeviceDriverSet_ULTRASONIC_Get(uint16_t *ULTRASONIC_Get /*out*/);
+  void DeviceDriverSet_ULTRASONIC_Update(void);                                                                   //Trigger/echo state machine：call once per loop
+  void DeviceDriverSet_ULTRASONIC_Get(uint16_t *ULTRASONIC_Get /*out*/);                                          //Latest distance (cm)：never blocks
+  void DeviceDriverSet_ULTRASONIC_Get(uint16_t *ULTRASONIC_Get /*out*/, unsigned long *ULTRASONIC_Millis /*out*/); //Latest distance (cm) and the millis() it was measured at
+  unsigned long DeviceDriverSet_ULTRASONIC_Age(void);                                                             //Age of the latest distance (ms)
+  void DeviceDriverSet_ULTRASONIC_SetPingPeriod(uint16_t PingPeriod_ms);
 
 private:
-#define TRIG_PIN 13      // Arduino pin tied to trigger pin on the ultrasonic sensor.
-#define ECHO_PIN 12      // Arduino pin tied to echo pin on the ultrasonic sensor.
+  typedef DeviceDriverSet_Pin<Board::TRIG_PIN> Trig_Pin; // Arduino pin tied to trigger pin on the ultrasonic sensor.
+  typedef DeviceDriverSet_Pin<Board::ECHO_PIN> Echo_Pin; // Arduino pin tied to echo pin on the ultrasonic sensor.
+  static_assert(Echo_Pin::Group == 0, "ECHO_PIN must be on PORTB (D8~D13)：the echo is timed by PCINT0_vect");
+  static_assert(Board::ECHO_PIN == DeviceDriverSet_Board::ECHO_PIN, "PCINT0_vect reads the ECHO_PIN of DeviceDriverSet_Board");
 #define MAX_DISTANCE 200 // Maximum distance we want to ping for (in centimeters). Maximum sensor distance is rated at 400-500cm.
+#define US_ROUNDTRIP_CM 58                                                  // Echo time per centimeter (us)
+#define ULTRASONIC_EchoTimeout_us ((unsigned long)MAX_DISTANCE * US_ROUNDTRIP_CM) // Round trip time of MAX_DISTANCE (us)
+#define ULTRASONIC_PingPeriod_Min (ULTRASONIC_EchoTimeout_us / 1000 + 1)           // Shortest ping period (ms)
+#define ULTRASONIC_PingPeriod_Default 30                                           // Default ping period (ms)
+#define ULTRASONIC_Distance_Max 150                                                // Distance reported when there is no echo in range (cm)
+  uint16_t PingPeriod = ULTRASONIC_PingPeriod_Default;
+  uint8_t Status = 0;
+  unsigned long Trigger_micros;
+  unsigned long Trigger_millis;
+  uint16_t Distance_cm = 0;
+  unsigned long Distance_millis = 0;
 };
-/*Servo*/
-#include <Servo.h>
+/*
+  Servo：both servos are driven all the time from Timer1 (fast PWM, TOP ICR1, 0.5us per count, 20ms period), so both
+  hold their position under load and move at the same time.
+  Servo_z (D10, OC1B) is a hardware compare output；D11 is OC2A, but Timer2 belongs to IRremote (OCR2A is its TOP),
+  so Servo_y is switched by TIMER1_OVF_vect (pulse start) and TIMER1_COMPA_vect (pulse end, OCR1A has no pin here：D9 is
+  the IR input)：two one-instruction interrupts per 20ms.
+*/
+template <class Board>
 class DeviceDriverSet_Servo
 {
+  static_assert(Board::PIN_Servo_z == 10, "PIN_Servo_z must be D10：the pulse is the OC1B output");
+  static_assert(Board::PIN_Servo_y == DeviceDriverSet_Board::PIN_Servo_y, "TIMER1_OVF_vect/TIMER1_COMPA_vect switch the PIN_Servo_y of DeviceDriverSet_Board");
+
 public:
   void DeviceDriverSet_Servo_Init(unsigned int Position_angle);
 #if _Test_DeviceDriverSet
   void DeviceDriverSet_Servo_Test(void);
 #endif
-  void DeviceDriverSet_Servo_control(unsigned int Position_angle);
-  void DeviceDriverSet_Servo_controls(uint8_t Servo, unsigned int Position_angle);
+  void DeviceDriverSet_Servo_control(unsigned int Position_angle);                  //Servo_z move：non-blocking
+  void DeviceDriverSet_Servo_controls(uint8_t Servo, unsigned int Position_angle); //Servo 1:z 2:y 3:both：non-blocking
+  void DeviceDriverSet_Servo_Update(void);                                         //Arrival of the moves：call once per loop
+  bool DeviceDriverSet_Servo_InPosition(uint8_t Servo);                            //No move running on the servo(s)
+  uint8_t DeviceDriverSet_Servo_GetEvent(void);                                    //"In position" events since the last call (1:z 2:y 3:both)
+
+private:
+  void DeviceDriverSet_Servo_move(uint8_t Servo_xxx, uint8_t Position_angle);
+  void DeviceDriverSet_Servo_Pulse(uint8_t Servo_xxx, uint8_t Position_angle);
 
 private:
-#define PIN_Servo_z 10
-#define PIN_Servo_y 11
+#define Servo_z 0
+#define Servo_y 1
+#define Servo_Settle_ms 40     //Margin after the estimated arrival before the servo is reported in position
+#define Servo_Pulse_Min 544    //us at 0 degree
+#define Servo_Pulse_Max 2400   //us at 180 degree
+#define Servo_Period 20000     //us
+  uint8_t Servo_Position[2];             //Angle the servo has arrived at
+  uint8_t Servo_Target[2];               //Commanded angle
+  uint8_t Servo_Moving = 0;              //Servos still on the way (1:z 2:y)
+  unsigned long Servo_Arrival_millis[2]; //Estimated arrival of each moving servo
+  uint8_t Servo_Event = 0;
 };
 /*IRrecv*/
 #include "IRremote.h"
@@ -0,0 +1,94 @@
+/*
+ * @Author: ELEGOO
+ * @Date: 2019-10-22 11:59:09
+ * @LastEditTime: 2020-06-12 17:22:13
+ * @LastEditors: Changhua
+ * @Description: Q16.16 fixed point for the control paths
+ * @FilePath:
+ */
+#ifndef _FixedPoint_Q16_H_
+#define _FixedPoint_Q16_H_
+#include <stdint.h>
+/*
+  q16_t：signed 16.16 fixed point (±32768, resolution 1/65536) in an int32_t.
+  Add/Sub/Mul saturate instead of wrapping；Mul rounds towards -∞ like (a * b) >> 16 and is built from 16x16 bit
+  products so the AVR never calls the 64 bit multiply；Q16_FromFloat is meant for constants (folded at compile time).
+*/
+typedef int32_t q16_t;
+#define Q16_One ((q16_t)0x00010000L)
+#define Q16_Max ((q16_t)0x7FFFFFFFL)
+#define Q16_Min ((q16_t)(-0x7FFFFFFFL - 1))
+
+constexpr q16_t Q16_FromFloat(float Value)
+{
+  return (q16_t)(Value * 65536.0f + ((Value >= 0) ? 0.5f : -0.5f));
+}
+inline q16_t Q16_FromInt(int16_t Value)
+{
+  return (q16_t)Value * 65536L;
+}
+/*Numerator / Denominator without going through float：rounds towards 0*/
+inline q16_t Q16_FromRatio(int16_t Numerator, int16_t Denominator)
+{
+  return ((q16_t)Numerator * 65536L) / Denominator;
+}
+/*Rounded to the nearest integer (halves up)；from 32767.5 up (Q16_Max included) it saturates to 32767*/
+inline int16_t Q16_ToInt(q16_t Value)
+{
+  if (Value >= (q16_t)0x7FFF8000L) //Value + 0x8000 would overflow, or round to 32768
+  {
+    return 0x7FFF;
+  }
+  return (int16_t)((Value + 0x8000L) >> 16);
+}
+inline float Q16_ToFloat(q16_t Value)
+{
+  return Value / 65536.0f;
+}
+inline q16_t Q16_Add(q16_t a, q16_t b)
+{
+  q16_t r = (q16_t)((uint32_t)a + (uint32_t)b);
+  if (((a ^ r) & (b ^ r)) < 0) //Both operands differ in sign from the result：overflow
+  {
+    return (a < 0) ? Q16_Min : Q16_Max;
+  }
+  return r;
+}
+inline q16_t Q16_Sub(q16_t a, q16_t b)
+{
+  q16_t r = (q16_t)((uint32_t)a - (uint32_t)b);
+  if (((a ^ b) & (a ^ r)) < 0)
+  {
+    return (a < 0) ? Q16_Min : Q16_Max;
+  }
+  return r;
+}
+inline q16_t Q16_Mul(q16_t a, q16_t b)
+{
+  /*a * b = (ah*bh << 32) + ((ah*bl + al*bh) << 16) + al*bl；Hi collects bits 32~63, Lo bits 16~31 plus carries*/
+  int16_t ah = (int16_t)(a >> 16), bh = (int16_t)(b >> 16);
+  uint16_t al = (uint16_t)a, bl = (uint16_t)b;
+  int32_t m1 = (int32_t)ah * bl, m2 = (int32_t)bh * al;
+  int32_t Hi = (int32_t)ah * bh + (m1 >> 16) + (m2 >> 16);
+  uint32_t Lo = (((uint32_t)al * bl) >> 16) + (uint16_t)m1 + (uint16_t)m2;
+  Hi += (int32_t)(Lo >> 16);
+  if (Hi > 0x7FFF)
+  {
+    return Q16_Max;
+  }
+  if (Hi < -0x8000)
+  {
+    return Q16_Min;
+  }
+  return (q16_t)(((uint32_t)Hi << 16) | (Lo & 0xFFFF));
+}
+inline q16_t Q16_MulInt(q16_t a, int16_t n)
+{
+  return Q16_Mul(a, Q16_FromInt(n));
+}
+/*Division by an integer：rounds towards 0*/
+inline q16_t Q16_DivInt(q16_t a, int16_t n)
+{
+  return a / n;
+}
+#endif
@@ -85,6 +85,15 @@ THE SOFTWARE.
     // Originally offered to the i2cdevlib project at http://arduino.cc/forum/index.php/topic,68210.30.html
     TwoWire Wire;
 
+#elif I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_TWIQUEUE
+
+    // Blocking use of the queue for the I2Cdev API: submit, then run the timeout check until it is finished
+    static bool twiQueueWait(TwiTransaction *t) {
+        while (!TwiQueue::submit(t)) TwiQueue::poll();
+        while (t->status == TWIQUEUE_PENDING) TwiQueue::poll();
+        return t->status == TWIQUEUE_DONE;
+    }
+
 #endif
 
 /** Default constructor.
@@ -301,6 +310,12 @@ int8_t I2Cdev::readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8
             count = -1; // error
         }
 
+    #elif (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_TWIQUEUE)
+
+        // one queued transaction, no chunking needed
+        TwiTransaction t = {devAddr, regAddr, data, length, true, timeout};
+        count = twiQueueWait(&t) ? length : -1;
+
     #endif
 
     // check for timeout
@@ -454,6 +469,20 @@ int8_t I2Cdev::readWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint1
             count = -1; // error
         }
 
+    #elif (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_TWIQUEUE)
+
+        // read the big-endian bytes straight into data, then swap each word in place
+        TwiTransaction t = {devAddr, regAddr, (uint8_t *)data, (uint8_t)(length * 2), true, timeout};
+        if (twiQueueWait(&t)) {
+            count = length;
+            for (uint8_t i = 0; i < length; i++) {
+                uint8_t *b = (uint8_t *)&data[i];
+                data[i] = ((uint16_t)b[0] << 8) | b[1];
+            }
+        } else {
+            count = -1;
+        }
+
     #endif
 
     if (timeout > 0 && millis() - t1 >= timeout && count < length) count = -1; // timeout
@@ -590,6 +619,10 @@ bool I2Cdev::writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_
         Serial.print(regAddr, HEX);
         Serial.print("...");
     #endif
+    #if (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_TWIQUEUE)
+        TwiTransaction t = {devAddr, regAddr, data, length, false, readTimeout};
+        return twiQueueWait(&t);
+    #endif
     uint8_t status = 0;
     #if ((I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE && ARDUINO < 100) || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_NBWIRE)
         Wire.beginTransmission(devAddr);
@@ -645,6 +678,15 @@ bool I2Cdev::writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16
         Serial.print(regAddr, HEX);
         Serial.print("...");
     #endif
+    #if (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_TWIQUEUE)
+        uint8_t bytes[length * 2];
+        for (uint8_t i = 0; i < length; i++) {
+            bytes[2*i] = data[i] >> 8;      // MSB first
+            bytes[2*i + 1] = data[i];
+        }
+        TwiTransaction t = {devAddr, regAddr, bytes, (uint8_t)(length * 2), false, readTimeout};
+        return twiQueueWait(&t);
+    #endif
     uint8_t status = 0;
     #if ((I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE && ARDUINO < 100) || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_NBWIRE)
         Wire.beginTransmission(devAddr);
@@ -1454,4 +1496,171 @@ uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
         return rxBufferLength - rxBufferIndex;
     }
 
-#endif
+#endif
+
+#if I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_TWIQUEUE
+    // Interrupt driven TWI master
+    // One transaction is on the bus at a time (active); the others wait in a ring of pointers. The TWI interrupt
+    // walks START, SLA+W, register, then either the data bytes and STOP (write) or a repeated START, SLA+R and the
+    // data bytes (ACK all but the last) and STOP (read). The next transaction is started together with the STOP.
+
+    #include <avr/interrupt.h>
+    #include <util/delay.h>
+    #include <util/twi.h>
+
+    static TwiTransaction * volatile twiActive = 0;
+    static TwiTransaction * volatile twiQueue[TWIQUEUE_LENGTH + 1];    // one slot stays free to tell full from empty
+    static volatile uint8_t twiHead = 0, twiTail = 0;
+    static volatile uint8_t twiIndex = 0;
+    uint16_t TwiQueue::timeouts = 0;
+    uint16_t TwiQueue::errors = 0;
+
+    #define TWCR_GO         (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+
+    // take the next queued transaction onto the bus (interrupts off), stop is set when the previous one just ended
+    static void twiStartNext(bool stop) {
+        if (twiHead == twiTail) {
+            twiActive = 0;
+            if (stop) TWCR = TWCR_GO | _BV(TWSTO);
+            return;
+        }
+        TwiTransaction *t = twiQueue[twiTail];
+        twiTail = (twiTail + 1) % (TWIQUEUE_LENGTH + 1);
+        t->started = millis();
+        twiActive = t;
+        TWCR = TWCR_GO | _BV(TWSTA) | (stop ? _BV(TWSTO) : 0);
+    }
+
+    static void twiFinish(uint8_t status, bool stop) {
+        TwiTransaction *t = twiActive;
+        t->status = status;
+        if (status != TWIQUEUE_DONE) TwiQueue::errors++;
+        twiStartNext(stop);
+        if (t->callback) t->callback(t);
+    }
+
+    void TwiQueue::setup(uint16_t khz, bool pullup) {
+        pinMode(SDA, pullup ? INPUT_PULLUP : INPUT);
+        pinMode(SCL, pullup ? INPUT_PULLUP : INPUT);
+        TWSR = 0;                                           // prescaler 1
+        TWBR = ((F_CPU / 1000L / khz) - 16) / 2;            // 400kHz: 12
+        TWCR = _BV(TWEN) | _BV(TWIE);
+    }
+
+    bool TwiQueue::submit(TwiTransaction *t) {
+        if (t->read && t->length == 0) {                    // the interrupt would store a byte into data[0]
+            t->status = TWIQUEUE_ERROR;
+            errors++;
+            if (t->callback) t->callback(t);
+            return true;
+        }
+        t->status = TWIQUEUE_PENDING;
+        if (t->timeout == 0) t->timeout = I2Cdev::readTimeout;
+        uint8_t sreg = SREG;
+        cli();
+        uint8_t next = (twiHead + 1) % (TWIQUEUE_LENGTH + 1);
+        if (next == twiTail) {
+            SREG = sreg;
+            return false;                                   // full
+        }
+        twiQueue[twiHead] = t;
+        twiHead = next;
+        if (twiActive == 0) twiStartNext(false);
+        SREG = sreg;
+        return true;
+    }
+
+    bool TwiQueue::idle() {
+        return twiActive == 0;
+    }
+
+    // abort a transaction that outlived its timeout and free the bus; call it from the main loop
+    void TwiQueue::poll() {
+        uint8_t sreg = SREG;
+        cli();
+        TwiTransaction *t = twiActive;
+        if (t != 0 && t->timeout != 0 && millis() - t->started > t->timeout) {
+            TWCR = 0;                                       // TWI off: the pins are plain GPIO again
+            recover();
+            TWCR = _BV(TWEN) | _BV(TWIE);
+            timeouts++;
+            twiFinish(TWIQUEUE_TIMEOUT, false);
+        }
+        SREG = sreg;
+    }
+
+    // a slave holding SDA low (reset in the middle of a read) lets go after at most 9 clocks; then send a STOP
+    void TwiQueue::recover() {
+        pinMode(SDA, INPUT_PULLUP);
+        for (uint8_t i = 0; i < 9 && digitalRead(SDA) == LOW; i++) {
+            pinMode(SCL, OUTPUT);                           // open drain: drive low or release
+            digitalWrite(SCL, LOW);
+            _delay_us(5);
+            pinMode(SCL, INPUT_PULLUP);
+            _delay_us(5);
+        }
+        pinMode(SDA, OUTPUT);
+        digitalWrite(SDA, LOW);
+        _delay_us(5);
+        pinMode(SCL, INPUT_PULLUP);
+        _delay_us(5);
+        pinMode(SDA, INPUT_PULLUP);                         // SDA rising while SCL high: STOP
+        _delay_us(5);
+    }
+
+    ISR(TWI_vect) {
+        TwiTransaction *t = twiActive;
+        if (t == 0) {
+            TWCR = _BV(TWEN);                               // nothing active: interrupt off until the next submit
+            return;
+        }
+        switch (TW_STATUS) {
+            case TW_START:
+                twiIndex = 0;
+                TWDR = t->devAddr << 1;                     // SLA+W: register address first
+                TWCR = TWCR_GO;
+                break;
+            case TW_MT_SLA_ACK:
+                TWDR = t->regAddr;
+                TWCR = TWCR_GO;
+                break;
+            case TW_MT_DATA_ACK:
+                if (t->read) {
+                    TWCR = TWCR_GO | _BV(TWSTA);            // repeated start
+                } else if (twiIndex < t->length) {
+                    TWDR = t->data[twiIndex++];
+                    TWCR = TWCR_GO;
+                } else {
+                    twiFinish(TWIQUEUE_DONE, true);
+                }
+                break;
+            case TW_REP_START:
+                TWDR = (t->devAddr << 1) | TW_READ;
+                TWCR = TWCR_GO;
+                break;
+            case TW_MR_SLA_ACK:
+                TWCR = TWCR_GO | (t->length > 1 ? _BV(TWEA) : 0);
+                break;
+            case TW_MR_DATA_ACK:
+                t->data[twiIndex++] = TWDR;
+                TWCR = TWCR_GO | (twiIndex < t->length - 1 ? _BV(TWEA) : 0);
+                break;
+            case TW_MR_DATA_NACK:
+                t->data[twiIndex++] = TWDR;
+                twiFinish(TWIQUEUE_DONE, true);
+                break;
+            case TW_MT_SLA_NACK:
+            case TW_MT_DATA_NACK:
+            case TW_MR_SLA_NACK:
+                twiFinish(TWIQUEUE_NACK, true);
+                break;
+            case TW_MT_ARB_LOST:                            // the bus is released by clearing TWINT
+                TWCR = TWCR_GO;
+                twiFinish(TWIQUEUE_ERROR, false);
+                break;
+            default:                                        // TW_BUS_ERROR: STOP resets the TWI
+                twiFinish(TWIQUEUE_ERROR, true);
+                break;
+        }
+    }
+#endif
@@ -1,11 +1,12 @@
 #ifndef _I2CDEV_H_
 #define _I2CDEV_H_
-#define I2CDEV_IMPLEMENTATION       I2CDEV_ARDUINO_WIRE
+#define I2CDEV_IMPLEMENTATION       I2CDEV_BUILTIN_TWIQUEUE
 #define I2CDEV_IMPLEMENTATION_WARNINGS
 #define I2CDEV_ARDUINO_WIRE         1
 #define I2CDEV_BUILTIN_NBWIRE       2
 #define I2CDEV_BUILTIN_FASTWIRE     3
 #define I2CDEV_I2CMASTER_LIBRARY    4
+#define I2CDEV_BUILTIN_TWIQUEUE     5
 #ifdef ARDUINO
     #if ARDUINO < 100
         #include "WProgram.h"
@@ -152,4 +153,40 @@ class I2Cdev {
     #endif
     extern TwoWire Wire;
 #endif
+#if I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_TWIQUEUE
+    // Interrupt driven TWI master with a transaction queue.
+    // A transaction is a register write (regAddr then data) or a register read (regAddr, repeated start, data);
+    // it stays owned by the caller, who polls status (or gets the callback, run from the TWI interrupt) until it
+    // is no longer TWIQUEUE_PENDING. A transaction active longer than its timeout is aborted and the bus is
+    // recovered (SCL clocked until SDA is released, then a STOP). A read of no bytes is not put on the bus: it ends
+    // at once as TWIQUEUE_ERROR. The I2Cdev read*/write* calls wrap it blocking.
+    #define TWIQUEUE_LENGTH         4       // transactions waiting behind the active one
+    #define TWIQUEUE_KHZ            400
+    #define TWIQUEUE_PENDING        0
+    #define TWIQUEUE_DONE           1
+    #define TWIQUEUE_NACK           2       // address or data not acknowledged
+    #define TWIQUEUE_ERROR          3       // arbitration lost or bus error
+    #define TWIQUEUE_TIMEOUT        4
+    struct TwiTransaction {
+        uint8_t devAddr;
+        uint8_t regAddr;
+        uint8_t *data;
+        uint8_t length;
+        bool read;
+        uint16_t timeout;                   // ms, 0 = I2Cdev::readTimeout
+        volatile uint8_t status;
+        void (*callback)(TwiTransaction *);
+        uint32_t started;                   // millis() when it went on the bus
+    };
+    class TwiQueue {
+        public:
+            static void setup(uint16_t khz, bool pullup);
+            static bool submit(TwiTransaction *t);
+            static void poll();
+            static void recover();
+            static bool idle();
+            static uint16_t timeouts;
+            static uint16_t errors;
+    };
+#endif
 #endif
@@ -7,15 +7,20 @@
  * @FilePath: 
  */
 
+#include "MPU6050_getdata.h"
 #include "I2Cdev.h"
+#if _MPU6050_DMP
+#include "MPU6050_6Axis_MotionApps20.h" //Declares and implements the dmp* members of MPU6050
+#else
 #include "MPU6050.h"
-#include "Wire.h"
-#include "MPU6050_getdata.h"
+#endif
 #include <stdio.h>
 #include <math.h>
 
 MPU6050 accelgyro;
 MPU6050_getdata MPU6050Getdata;
+static TwiTransaction MPU6050_Request;
+static uint8_t MPU6050_Buffer[MPU6050_getdata_Burst * 2];
 
 // static void MsTimer2_MPU6050getdata(void)
 // {
@@ -28,7 +33,7 @@ MPU6050_getdata MPU6050Getdata;
 
 bool MPU6050_getdata::MPU6050_dveInit(void)
 {
-  Wire.begin();
+  TwiQueue::setup(TWIQUEUE_KHZ, true);
   uint8_t chip_id = 0x00;
   uint8_t cout;
   do
@@ -43,7 +48,22 @@ bool MPU6050_getdata::MPU6050_dveInit(void)
       return true;
     }
   } while (chip_id == 0X00 || chip_id == 0XFF); //Ensure that the slave device is online（Wait forcibly to get the ID）
+  Online = true;
   accelgyro.initialize();
+#if _MPU6050_DMP
+  if (0 != accelgyro.dmpInitialize()) //Firmware upload or configuration failed
+  {
+    return true;
+  }
+  accelgyro.setDMPEnabled(true);
+  accelgyro.resetFIFO();
+  return false;
+#endif
+  accelgyro.setDLPFMode(MPU6050_DLPF_BW_42);
+  accelgyro.setRate(MPU6050_getdata_RateDiv);
+  accelgyro.setZGyroFIFOEnabled(true); //Only gyro Z：2 bytes per sample
+  accelgyro.setFIFOEnabled(true);
+  accelgyro.resetFIFO();
   // unsigned short times = 100; //Sampling times
   // for (int i = 0; i < times; i++)
   // {
@@ -53,31 +73,218 @@ bool MPU6050_getdata::MPU6050_dveInit(void)
   // gzo /= times; //Calculate gyroscope offset
   return false;
 }
+/*Forget the bias estimate：the next still window sets it again (nothing is sampled here)*/
 bool MPU6050_getdata::MPU6050_calibration(void)
 {
-  unsigned short times = 100; //Sampling times
-  for (int i = 0; i < times; i++)
+  Bias_Valid = false;
+  Still_Count = 0;
+  return false;
+}
+/*
+  Online zero rate bias：every FIFO sample goes through here. Samples are collected in windows of
+  MPU6050_getdata_StillSamples while the motors are stopped；a sample more than MPU6050_getdata_StillRate away from
+  the first one (the car is moving) or a running motor restarts the window. A full window whose variance is below
+  MPU6050_getdata_StillVar is the car at rest：its mean moves the bias 1/2^MPU6050_getdata_BiasShift of the way
+  (or sets it, the first time). With _MPU6050_TempComp the bias also follows the chip temperature between windows.
+*/
+void MPU6050_getdata::MPU6050_dveBias(int16_t Sample)
+{
+  long d = (long)Sample - Still_Ref;
+  if (false == Motor_Stopped || 0 == Still_Count || labs(d) > MPU6050_getdata_StillRate)
   {
-    gz = accelgyro.getRotationZ();
-    gzo += gz;
+    Still_Ref = Sample;
+    Still_Sum = 0;
+    Still_Sum2 = 0;
+    Still_Count = Motor_Stopped ? 1 : 0;
+    return;
   }
-  gzo /= times; //Calculate gyroscope offset
-
-  // gzo = accelgyro.getRotationZ();
+  Still_Sum += d;
+  Still_Sum2 += d * d;
+  Still_Count += 1;
+  if (Still_Count < MPU6050_getdata_StillSamples)
+  {
+    return;
+  }
+  long n = Still_Count - 1; //The reference sample itself is not in the sums
+  long mean_q8 = ((long)Still_Ref << 8) + Still_Sum * 256 / n;
+  bool still = (Still_Sum2 - Still_Sum * Still_Sum / n) / n <= MPU6050_getdata_StillVar;
+  Still_Count = 0;
+  if (false == still)
+  {
+    return;
+  }
+#if _MPU6050_TempComp
+  if (Temp_Valid)
+  {
+    if (false == Bias_Valid)
+    {
+      Temp_kRef = Temp;
+      Bias_kRef_q8 = mean_q8;
+    }
+    else if (abs(Temp - Temp_kRef) >= MPU6050_getdata_TempStep)
+    {
+      long k = (mean_q8 - Bias_kRef_q8) * 256 / (Temp - Temp_kRef);
+      Temp_k += (k - Temp_k) / 4;
+      Temp_kRef = Temp;
+      Bias_kRef_q8 = mean_q8;
+    }
+    Temp_Ref = Temp;
+  }
+#endif
+  if (false == Bias_Valid)
+  {
+    gzo_q8 = mean_q8;
+    Bias_Valid = true;
+  }
+  else
+  {
+    gzo_q8 += (mean_q8 - gzo_q8) >> MPU6050_getdata_BiasShift;
+  }
+  MPU6050_dveBiasApply();
+}
+/*gzo for the integration：the estimate, moved along the temperature slope since the last still window*/
+void MPU6050_getdata::MPU6050_dveBiasApply(void)
+{
+  long bias_q8 = gzo_q8;
+#if _MPU6050_TempComp
+  if (Temp_Valid && Bias_Valid)
+  {
+    bias_q8 += Temp_k * (Temp - Temp_Ref) / 256;
+  }
+#endif
+  gzo = (bias_q8 + 128) >> 8;
+}
+/*Accelerometer (±2g, 16384 LSB/g) in one 6 byte read：true when the chip is not there*/
+bool MPU6050_getdata::MPU6050_dveGetAcceleration(int16_t *ax, int16_t *ay, int16_t *az)
+{
+  if (false == Online)
+  {
+    return true;
+  }
+  accelgyro.getAcceleration(ax, ay, az);
+  return false;
+}
+#if !_MPU6050_DMP
+/*
+  Yaw from the FIFO：the MPU6050 samples gyro Z at a fixed 100Hz whatever the caller's period,
+  every queued sample is integrated with its own dt, read MPU6050_getdata_Burst samples per I2C transfer.
+  Integration is in fixed point：each sample adds rate * MPU6050_getdata_Scale in Q28 and the bits below Q16 are carried.
+  The reads never block：MPU6050_dveUpdate() (every loop) queues the FIFO count read, picks it up on a later call and
+  queues the sample read, picks that up and integrates it, and so on.
+  A full FIFO has lost samples：it is reset and the yaw is held (true is returned).
+*/
+bool MPU6050_getdata::MPU6050_dveUpdate(void)
+{
+  if (false == Online)
+  {
+    return false;
+  }
+  TwiQueue::poll();
+#if _MPU6050_TempComp
+  static unsigned long Temp_millis = 0;
+  if (millis() - Temp_millis > MPU6050_getdata_TempPeriod) //2 bytes through the blocking wrapper once a second
+  {
+    Temp_millis = millis();
+    Temp = accelgyro.getTemperature();
+    Temp_Valid = true;
+    MPU6050_dveBiasApply();
+  }
+#endif
+  if (0 != Phase && TWIQUEUE_PENDING == MPU6050_Request.status) //Still on the bus
+  {
+    return false;
+  }
+  if (1 == Phase && TWIQUEUE_DONE == MPU6050_Request.status)
+  {
+    uint16_t count = ((uint16_t)MPU6050_Buffer[0] << 8) | MPU6050_Buffer[1];
+    if (count >= MPU6050_getdata_FIFO_Max)
+    {
+      accelgyro.resetFIFO();
+      Overflow += 1;
+      Phase = 0;
+      return true;
+    }
+    count /= 2;
+    if (count > 0)
+    {
+      uint8_t n = (count > MPU6050_getdata_Burst) ? MPU6050_getdata_Burst : count;
+      MPU6050_Request = {MPU6050_DEFAULT_ADDRESS, MPU6050_RA_FIFO_R_W, MPU6050_Buffer, (uint8_t)(n * 2), true, MPU6050_getdata_Timeout};
+      Phase = TwiQueue::submit(&MPU6050_Request) ? 2 : 0;
+      return false;
+    }
+  }
+  else if (2 == Phase && TWIQUEUE_DONE == MPU6050_Request.status)
+  {
+    for (uint8_t i = 0; i < MPU6050_Request.length; i += 2)
+    {
+      gz = (int16_t)(((uint16_t)MPU6050_Buffer[i] << 8) | MPU6050_Buffer[i + 1]);
+      MPU6050_dveBias(gz);
+      long rate = constrain(gz - gzo, -32767L, 32767L);
+      if (labs(rate) >= MPU6050_getdata_Deadband) //Clear instant zero drift signal
+      {
+        MPU6050_getdata_Integrate(agz, agz_fraction, rate); //z-axis angular velocity integral
+      }
+    }
+  }
+  MPU6050_Request = {MPU6050_DEFAULT_ADDRESS, MPU6050_RA_FIFO_COUNTH, MPU6050_Buffer, 2, true, MPU6050_getdata_Timeout};
+  Phase = TwiQueue::submit(&MPU6050_Request) ? 1 : 0;
   return false;
 }
-bool MPU6050_getdata::MPU6050_dveGetEulerAngles(float *Yaw)
+bool MPU6050_getdata::MPU6050_dveGetEulerAngles(q16_t *Yaw)
 {
-  unsigned long now = millis();           //Record the current time(ms)
-  dt = (now - lastTime) / 1000.0;         //Caculate the derivative time(s)
-  lastTime = now;                         //Record the last sampling time(ms)
-  gz = accelgyro.getRotationZ();          //Read the raw values of the six axes
-  float gyroz = -(gz - gzo) / 131.0 * dt; //z-axis angular velocity
-  if (fabs(gyroz) < 0.05)                 //Clear instant zero drift signal
+  bool overflow = MPU6050_dveUpdate();
+  *Yaw = agz;
+  return overflow;
+}
+#else
+/*
+  Yaw/pitch/roll from the DMP quaternion packets (Q14 w, x, y, z at the start of each packet)：
+  only the newest packet counts, yaw is unwrapped into the continuous agz with the sign of the gyro mode.
+*/
+bool MPU6050_getdata::MPU6050_dveGetEulerAngles(q16_t *Yaw)
+{
+  uint8_t packet[64];
+  uint16_t size = accelgyro.dmpGetFIFOPacketSize();
+  uint16_t count = accelgyro.getFIFOCount();
+  if (count >= MPU6050_getdata_FIFO_Max || size > sizeof(packet))
+  {
+    accelgyro.resetFIFO();
+    Overflow += 1;
+    *Yaw = agz;
+    return true;
+  }
+  if (count < size)
   {
-    gyroz = 0.00;
+    *Yaw = agz;
+    return false;
   }
-  agz += gyroz; //z-axis angular velocity integral
+  while (count >= size)
+  {
+    accelgyro.getFIFOBytes(packet, size);
+    count -= size;
+  }
+  int16_t q[4];
+  accelgyro.dmpGetQuaternion(q, packet);
+  float w = q[0] / 16384.0f, x = q[1] / 16384.0f, y = q[2] / 16384.0f, z = q[3] / 16384.0f;
+  float yaw = -atan2(2 * (w * z + x * y), 1 - 2 * (y * y + z * z)) * RAD_TO_DEG;
+  pitch = asin(constrain(2 * (w * y - z * x), -1.0f, 1.0f)) * RAD_TO_DEG;
+  roll = atan2(2 * (w * x + y * z), 1 - 2 * (x * x + y * y)) * RAD_TO_DEG;
+  float delta = isnan(yaw_last) ? 0 : yaw - yaw_last; //First packet：start from the current agz
+  if (delta > 180)
+  {
+    delta -= 360;
+  }
+  else if (delta < -180)
+  {
+    delta += 360;
+  }
+  yaw_last = yaw;
+  agz = Q16_Add(agz, (q16_t)(delta * 65536.0f));
   *Yaw = agz;
   return false;
 }
+bool MPU6050_getdata::MPU6050_dveUpdate(void) //DMP packets are read blocking in MPU6050_dveGetEulerAngles
+{
+  return false;
+}
+#endif
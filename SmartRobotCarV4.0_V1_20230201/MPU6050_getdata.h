@@ -9,21 +9,79 @@
 #ifndef _MPU6050_getdata_H_
 #define _MPU6050_getdata_H_
 #include <Arduino.h>
+#include "FixedPoint_Q16.h"
+/*
+  Orientation source：
+  0：gyro Z from the FIFO integrated on the UNO (yaw only)
+  1：InvenSense DMP fusion (MotionApps 2.0, yaw/pitch/roll)：needs MPU6050_6Axis_MotionApps20.h and helper_3dmath.h
+     from i2cdevlib next to the sketch, costs about 2KB of flash for the DMP firmware
+*/
+#define _MPU6050_DMP 0
+/*Gyro sampling：DLPF 42Hz (1kHz gyro clock), 1kHz / (1 + 9) = 100Hz into the FIFO*/
+#define MPU6050_getdata_RateDiv 9
+#define MPU6050_getdata_Scale 20491L   //Degrees per LSB per sample (0.01s / 131 LSB/°/s = 20491.26) in Q4.28
+#define MPU6050_getdata_Burst 32      //Samples per queued I2C read (2 bytes each)
+#define MPU6050_getdata_Timeout 10    //ms：a queued read still on the bus after this is aborted and the bus recovered
+#define MPU6050_getdata_FIFO_Max 1024 //FIFO size：full means samples were lost
+#define MPU6050_getdata_Deadband 655  //LSB：|gz - gzo| below 5°/s is treated as zero drift
+/*One sample into the yaw：-rate * MPU6050_getdata_Scale in Q28, the bits below the Q16 resolution carried in Fraction*/
+inline void MPU6050_getdata_Integrate(q16_t &Yaw, uint16_t &Fraction, long rate)
+{
+  long step = Fraction - rate * MPU6050_getdata_Scale;
+  Yaw = Q16_Add(Yaw, step >> 12);
+  Fraction = step & 0x0FFF;
+}
+/*Zero rate bias：estimated online from still windows (motors stopped, gyro quiet)*/
+#define MPU6050_getdata_StillSamples 50 //0.5s window
+#define MPU6050_getdata_StillRate 200   //LSB：a sample this far from the window's first sample breaks the window
+#define MPU6050_getdata_StillVar 100    //LSB²：window variance limit (the noise at DLPF 42Hz is ~40)
+#define MPU6050_getdata_BiasShift 3     //each still window moves the bias 1/8 of the way
+/*Temperature compensation of the bias：slope learnt between still windows at least 1°C apart*/
+#define _MPU6050_TempComp 0
+#define MPU6050_getdata_TempPeriod 1000 //ms
+#define MPU6050_getdata_TempStep 340    //Temperature LSB per °C
 class MPU6050_getdata
 {
 public:
   bool MPU6050_dveInit(void);
   bool MPU6050_calibration(void);
-  bool MPU6050_dveGetEulerAngles(float *Yaw);
+  bool MPU6050_dveGetEulerAngles(q16_t *Yaw);
+  bool MPU6050_dveUpdate(void);
+  bool MPU6050_dveGetAcceleration(int16_t *ax, int16_t *ay, int16_t *az);
+
+private:
+  void MPU6050_dveBias(int16_t Sample);
+  void MPU6050_dveBiasApply(void);
 
 public:
   //int16_t ax, ay, az, gx, gy, gz;
   int16_t gz;
   //float pith, roll, yaw;
-  unsigned long now, lastTime = 0;
-  float dt;      //Derivative time
-  float agz = 0; //Angle variable
-  long gzo = 0;  //Gyro offset
+  q16_t agz = 0;                 //Angle variable (degrees)
+  uint16_t agz_fraction = 0;     //Q28 remainder below the Q16 resolution of agz
+#if _MPU6050_DMP
+  float pitch = 0, roll = 0;     //DMP only：degrees
+  float yaw_last = NAN;          //Last DMP yaw (-180~180) for the continuous agz
+#endif
+  long gzo = 0;                  //Gyro offset (LSB, used by the integration)
+  long gzo_q8 = 0;               //Estimated bias in 1/256 LSB
+  bool Bias_Valid = false;       //A still window has been seen：until then the first one sets the bias outright
+  bool Motor_Stopped = true;     //Set by the caller：the motors have been off long enough for the car to be at rest
+  uint8_t Still_Count = 0;
+  int16_t Still_Ref = 0;         //First sample of the window
+  long Still_Sum = 0;
+  unsigned long Still_Sum2 = 0;
+#if _MPU6050_TempComp
+  int16_t Temp = 0;              //Raw temperature (340 LSB/°C)
+  int16_t Temp_Ref = 0;          //Temperature of the last accepted window
+  int16_t Temp_kRef = 0;         //Temperature and bias the slope is measured from
+  long Bias_kRef_q8 = 0;
+  long Temp_k = 0;               //Bias slope：1/256 gyro LSB per temperature LSB, in Q8
+  bool Temp_Valid = false;
+#endif
+  uint16_t Overflow = 0;         //FIFO overflows (samples lost)
+  bool Online = false;           //Chip answered in MPU6050_dveInit
+  uint8_t Phase = 0;             //Queued FIFO read in flight：0 none, 1 count, 2 samples
 };
 
 extern MPU6050_getdata MPU6050Getdata;
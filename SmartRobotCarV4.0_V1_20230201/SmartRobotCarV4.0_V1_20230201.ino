@@ -9,6 +9,8 @@
 #include <avr/wdt.h>
 #include "ApplicationFunctionSet_xxx0.h"
 
+#define _Test_LoopCost 0 //Print the per-iteration cost of loop()
+
 void setup()
 {
   // put your setup code here, to run once:
@@ -19,24 +21,40 @@ void setup()
 void loop()
 {
   //put your main code here, to run repeatedly :
+#if _Test_LoopCost
+  unsigned long LoopCost_start = micros();
+#endif
   wdt_reset();
   Application_FunctionSet.ApplicationFunctionSet_SensorDataUpdate();
   Application_FunctionSet.ApplicationFunctionSet_KeyCommand();
   Application_FunctionSet.ApplicationFunctionSet_RGB();
-  Application_FunctionSet.ApplicationFunctionSet_Follow();
-  Application_FunctionSet.ApplicationFunctionSet_Obstacle();
-  Application_FunctionSet.ApplicationFunctionSet_Tracking();
-  Application_FunctionSet.ApplicationFunctionSet_Rocker();
-  Application_FunctionSet.ApplicationFunctionSet_Standby();
   Application_FunctionSet.ApplicationFunctionSet_IRrecv();
   Application_FunctionSet.ApplicationFunctionSet_SerialPortDataAnalysis();
-
-  Application_FunctionSet.CMD_ServoControl_xxx0();
-  Application_FunctionSet.CMD_MotorControl_xxx0();
-  Application_FunctionSet.CMD_CarControlTimeLimit_xxx0();
-  Application_FunctionSet.CMD_CarControlNoTimeLimit_xxx0();
-  Application_FunctionSet.CMD_MotorControlSpeed_xxx0();
-  Application_FunctionSet.CMD_LightingControlTimeLimit_xxx0();
-  Application_FunctionSet.CMD_LightingControlNoTimeLimit_xxx0();
-  Application_FunctionSet.CMD_ClearAllFunctions_xxx0();
+  Application_FunctionSet.ApplicationFunctionSet_ModeDispatch();
+#if _Test_LoopCost
+  { /*Per-iteration cost：average and worst case over 1000 passes (us)*/
+    static unsigned long LoopCost_sum = 0;
+    static unsigned long LoopCost_max = 0;
+    static uint16_t LoopCost_number = 0;
+    unsigned long LoopCost = micros() - LoopCost_start;
+    LoopCost_sum += LoopCost;
+    if (LoopCost > LoopCost_max)
+    {
+      LoopCost_max = LoopCost;
+    }
+    if (++LoopCost_number == 1000) //One line through the TX ring：never splits a queued reply
+    {
+      char LoopCost_line[56];
+      strcpy(LoopCost_line, "LoopCost_avg=");
+      ultoa(LoopCost_sum / LoopCost_number, LoopCost_line + strlen(LoopCost_line), 10);
+      strcat(LoopCost_line, "\tLoopCost_max=");
+      ultoa(LoopCost_max, LoopCost_line + strlen(LoopCost_line), 10);
+      strcat(LoopCost_line, "\r\n");
+      Application_FunctionSet.ApplicationFunctionSet_SerialPortPrint(LoopCost_line);
+      LoopCost_sum = 0;
+      LoopCost_max = 0;
+      LoopCost_number = 0;
+    }
+  }
+#endif
 }
@@ -0,0 +1,117 @@
+/*
+  Host stand-in for the Arduino core：simulated clock, pins, registers and Serial (see stub/Arduino.h)
+*/
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <FastLED.h>
+#include <avr/wdt.h>
+
+static unsigned long HostArduino_Micros = 0;
+void HostArduino_Advance(unsigned long Micros)
+{
+  HostArduino_Micros += Micros;
+}
+unsigned long millis(void)
+{
+  return HostArduino_Micros / 1000;
+}
+unsigned long micros(void)
+{
+  return HostArduino_Micros;
+}
+void delay(unsigned long ms)
+{
+  HostArduino_Micros += ms * 1000;
+}
+void delayMicroseconds(unsigned int us)
+{
+  HostArduino_Micros += us;
+}
+
+uint8_t HostArduino_Pin[20];
+unsigned long HostArduino_PinWrites = 0;
+static int HostArduino_AnalogZero(uint8_t)
+{
+  return 0;
+}
+int (*HostArduino_AnalogRead)(uint8_t Pin) = HostArduino_AnalogZero;
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t Pin, uint8_t Level)
+{
+  HostArduino_PinWrites++;
+  HostArduino_Pin[Pin] = Level;
+}
+int digitalRead(uint8_t Pin)
+{
+  return HostArduino_Pin[Pin];
+}
+int analogRead(uint8_t Pin)
+{
+  return HostArduino_AnalogRead(Pin);
+}
+void analogWrite(uint8_t Pin, int Value)
+{
+  HostArduino_PinWrites++;
+  HostArduino_Pin[Pin] = Value;
+}
+unsigned long pulseIn(uint8_t, uint8_t, unsigned long)
+{
+  return 0;
+}
+void attachInterrupt(uint8_t, void (*)(void), int) {}
+void noInterrupts(void) {}
+void interrupts(void) {}
+void wdt_reset(void) {}
+void wdt_enable(int) {}
+
+static char *HostArduino_Digits(unsigned long Value, char *s, int Base, bool Negative)
+{
+  char t[34];
+  int n = 0;
+  do
+  {
+    t[n++] = "0123456789abcdefghijklmnopqrstuvwxyz"[Value % Base];
+    Value /= Base;
+  } while (Value);
+  char *p = s;
+  if (Negative)
+    *p++ = '-';
+  while (n)
+    *p++ = t[--n];
+  *p = '\0';
+  return s;
+}
+char *ltoa(long Value, char *s, int Base)
+{
+  return (Value < 0 && Base == 10) ? HostArduino_Digits(-(unsigned long)Value, s, Base, true) : HostArduino_Digits((unsigned long)Value, s, Base, false);
+}
+char *ultoa(unsigned long Value, char *s, int Base)
+{
+  return HostArduino_Digits(Value, s, Base, false);
+}
+char *utoa(unsigned int Value, char *s, int Base)
+{
+  return HostArduino_Digits(Value, s, Base, false);
+}
+char *itoa(int Value, char *s, int Base)
+{
+  return ltoa(Value, s, Base);
+}
+
+unsigned long HostHeap::Allocations = 0;
+long HostHeap::Bytes = 0;
+long HostHeap::Peak = 0;
+
+volatile uint8_t PORTB, PORTC, PORTD, DDRB, DDRC, DDRD, PINB, PINC, PIND;
+volatile uint8_t PCICR, PCMSK0, PCMSK1, PCMSK2, PCIFR;
+volatile uint8_t ADMUX, ADCSRA, ADCSRB, ADCL, ADCH, DIDR0;
+volatile uint8_t TCCR0A, TCCR0B, OCR0A, OCR0B;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint8_t TCCR2A, TCCR2B, OCR2A, OCR2B, TIMSK2, TCNT2;
+volatile uint8_t TWBR, TWSR, TWCR, TWDR, TWAR, SREG;
+volatile uint8_t UCSR0A, UCSR0B, UCSR0C, UDR0, UBRR0H, UBRR0L;
+volatile uint16_t OCR1A, OCR1B, ICR1, TCNT1, ADC, UBRR0;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+CFastLED FastLED;
@@ -0,0 +1,36 @@
+/*
+  Host bench helpers：corpus loading and a small report format shared by the benchmarks and simulations.
+*/
+#ifndef _HostBench_H_
+#define _HostBench_H_
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*One frame per line；empty lines and lines starting with '#' are skipped*/
+inline std::vector<std::string> HostBench_Corpus(const char *Path)
+{
+  std::vector<std::string> Frames;
+  std::ifstream File(Path);
+  std::string Line;
+  while (std::getline(File, Line))
+  {
+    if (!Line.empty() && Line.back() == '\r')
+    {
+      Line.pop_back();
+    }
+    if (!Line.empty() && Line[0] != '#')
+    {
+      Frames.push_back(Line);
+    }
+  }
+  if (Frames.empty())
+  {
+    fprintf(stderr, "%s：no frames\n", Path);
+    exit(2);
+  }
+  return Frames;
+}
+#endif
@@ -0,0 +1,269 @@
+/*
+  Host car：physics and the simulated drivers the sketch runs against (see HostCar.h)
+*/
+#include <random> //Before the Arduino min/max macros
+#include "HostCar.h"
+#include "ApplicationFunctionSet_xxx0.h"
+#include "DeviceDriverSet_xxx0.h"
+#include "MPU6050_getdata.h"
+
+HostCar_Params HostCar_Param;
+HostCar_State HostCar;
+double (*HostCar_Line)(double X, double Y) = NULL;
+
+/*Outputs of the simulated TB6612 (what DeviceDriverSet_Motor_control last wrote)*/
+static bool HostCar_STBY = false;
+static int HostCar_Output[2] = {0, 0};
+/*Gyro：samples at 100Hz like the MPU6050 FIFO, integrated the way MPU6050_getdata does it*/
+static std::mt19937 HostCar_Random(1);
+static unsigned long HostCar_Gyro_us = 0;
+static q16_t HostCar_Yaw = 0;
+static uint16_t HostCar_Yaw_fraction = 0;
+
+void HostCar_Reset(const HostCar_Params &Params)
+{
+  HostCar_Param = Params;
+  memset(&HostCar, 0, sizeof(HostCar));
+  HostCar.Voltage = HostCar.Voltage_Min = Params.Battery;
+  HostCar.Accel[2] = 16384;
+  HostCar_STBY = false;
+  HostCar_Output[0] = HostCar_Output[1] = 0;
+  HostCar_Random.seed(1);
+  HostCar_Gyro_us = 0;
+  HostCar_Yaw = 0;
+  HostCar_Yaw_fraction = 0;
+}
+static double HostCar_Sign(double v)
+{
+  return (v > 0) - (v < 0);
+}
+/*Gyro Z as the MPU6050 reports it (131 LSB per °/s, positive counter-clockwise)*/
+int16_t HostCar_GyroSample(void)
+{
+  std::normal_distribution<double> noise(0, HostCar_Param.Gyro_Noise);
+  return (int16_t)constrain(lround(-HostCar.YawRate * 131 + noise(HostCar_Random)), -32768L, 32767L);
+}
+void HostCar_Step(unsigned long Micros)
+{
+  const HostCar_Params &P = HostCar_Param;
+  const double dt = 100e-6, g = 9.81;
+  for (unsigned long t = 0; t < Micros; t += 100)
+  {
+    double D[2], I[2], F[2];
+    for (int i = 0; i < 2; i++)
+    {
+      HostCar.Duty[i] = HostCar_STBY ? HostCar_Output[i] : 0;
+      D[i] = HostCar.Duty[i] / 255.0;
+    }
+    if (HostCar.Duty[0] == 0 && HostCar.Duty[1] == 0)
+    {
+      HostCar.Motors_Off_us += 100;
+    }
+    double Vb = P.Battery;
+    for (int pass = 0; pass < 3; pass++) //The sag needs the current it causes
+    {
+      double Ib = 0;
+      for (int i = 0; i < 2; i++)
+      {
+        I[i] = HostCar_STBY ? (Vb * D[i] - P.Motor_k[i] * HostCar.Wheel_w[i]) / P.Motor_R : 0; //PWM low：short brake
+        Ib += I[i] * D[i]; //Drawn from the battery only while the output is on
+      }
+      Vb = P.Battery - P.Battery_R * Ib;
+      HostCar.Current = Ib;
+    }
+    HostCar.Voltage = Vb;
+    HostCar.Current_Peak = max(HostCar.Current_Peak, fabs(HostCar.Current));
+    HostCar.Voltage_Min = min(HostCar.Voltage_Min, Vb);
+
+    double r = -HostCar.YawRate / RAD_TO_DEG; //rad/s counter-clockwise
+    for (int i = 0; i < 2; i++)
+    {
+      double vc = HostCar.Speed + ((i == 0) ? 1 : -1) * r * P.Track / 2; //A is the right side (y = -Track/2)
+      double Fmax = P.Grip[i] * P.Mass * g / 2;
+      F[i] = constrain(P.Slip_Stiffness * (HostCar.Wheel_w[i] * P.Wheel_r - vc), -Fmax, Fmax);
+      double T = P.Motor_k[i] * I[i] - F[i] * P.Wheel_r;
+      double w = HostCar.Wheel_w[i];
+      if (w == 0 && fabs(T) <= P.Wheel_Friction) //Stuck in the gearbox friction
+      {
+        continue;
+      }
+      w += (T - P.Wheel_Friction * HostCar_Sign((w != 0) ? w : T)) / P.Wheel_J * dt;
+      HostCar.Wheel_w[i] = (w * HostCar.Wheel_w[i] < 0) ? 0 : w; //Friction stops the wheel, never reverses it
+    }
+    HostCar.Speed += (F[0] + F[1]) / P.Mass * dt;
+    r += ((F[0] - F[1]) * P.Track / 2 - P.Scrub * tanh(r / 0.5)) / P.Inertia * dt;
+    double psi = -HostCar.Heading / RAD_TO_DEG;
+    HostCar.X += HostCar.Speed * cos(psi) * dt;
+    HostCar.Y += HostCar.Speed * sin(psi) * dt;
+    HostCar.YawRate = -r * RAD_TO_DEG;
+    HostCar.Heading += HostCar.YawRate * dt;
+    HostArduino_Advance(100);
+
+    HostCar_Gyro_us += 100;
+    if (HostCar_Gyro_us >= 10000) //FIFO sample：same dead band and Q28 step as MPU6050_getdata
+    {
+      HostCar_Gyro_us -= 10000;
+      long rate = HostCar_GyroSample();
+      if (labs(rate) >= MPU6050_getdata_Deadband)
+      {
+        MPU6050_getdata_Integrate(HostCar_Yaw, HostCar_Yaw_fraction, rate);
+      }
+    }
+  }
+}
+int HostCar_Ir(int Sensor)
+{
+  if (HostCar.Ir_Blind)
+  {
+    return 1000;
+  }
+  if (NULL == HostCar_Line)
+  {
+    return 60;
+  }
+  double psi = -HostCar.Heading / RAD_TO_DEG;
+  double s = (1 - Sensor) * HostCar_Sensor_Spacing; //L is on the left (+y)
+  double x = HostCar.X + HostCar_Sensor_Ahead * cos(psi) - s * sin(psi);
+  double y = HostCar.Y + HostCar_Sensor_Ahead * sin(psi) + s * cos(psi);
+  double d = HostCar_Line(x, y);
+  /*Sensor spot of 3mm (1σ) over the tape：white floor 60, black 700*/
+  double cover = 0.5 * (erf((HostCar_Line_Width / 2 - d) / (0.003 * M_SQRT2)) - erf((-HostCar_Line_Width / 2 - d) / (0.003 * M_SQRT2)));
+  return (int)lround(60 + 640 * cover);
+}
+void HostCar_Setup(void)
+{
+  Application_FunctionSet.ApplicationFunctionSet_Init();
+}
+void HostCar_Loop(unsigned long Micros)
+{
+  Application_FunctionSet.ApplicationFunctionSet_SensorDataUpdate();
+  Application_FunctionSet.ApplicationFunctionSet_KeyCommand();
+  Application_FunctionSet.ApplicationFunctionSet_RGB();
+  Application_FunctionSet.ApplicationFunctionSet_IRrecv();
+  Application_FunctionSet.ApplicationFunctionSet_SerialPortDataAnalysis();
+  Application_FunctionSet.ApplicationFunctionSet_ModeDispatch();
+  HostCar_Step(Micros);
+}
+
+/*Simulated drivers*/
+void DeviceDriverSet_RBGLED::DeviceDriverSet_RBGLED_Init(uint8_t) {}
+void DeviceDriverSet_RBGLED::DeviceDriverSet_RBGLED_xxx(uint16_t, uint8_t, CRGB) {}
+void DeviceDriverSet_RBGLED::DeviceDriverSet_RBGLED_Color(uint8_t, uint8_t, uint8_t, uint8_t) {}
+
+template <class Board>
+uint8_t DeviceDriverSet_Key<Board>::keyValue = 0;
+template <class Board>
+void DeviceDriverSet_Key<Board>::DeviceDriverSet_Key_Init(void) {}
+template <class Board>
+void DeviceDriverSet_Key<Board>::DeviceDriverSet_key_Get(uint8_t *get_keyValue)
+{
+  *get_keyValue = keyValue;
+}
+
+void DeviceDriverSet_ADC::DeviceDriverSet_ADC_Init(void) {}
+
+template <class Board>
+bool DeviceDriverSet_ITR20001<Board>::DeviceDriverSet_ITR20001_Init(void)
+{
+  return false;
+}
+template <class Board>
+uint16_t DeviceDriverSet_ITR20001<Board>::DeviceDriverSet_ITR20001_Get(int *L, int *M, int *R)
+{
+  *L = HostCar_Ir(0);
+  *M = HostCar_Ir(1);
+  *R = HostCar_Ir(2);
+  return (uint16_t)(micros() / 1000); //A fresh scan every millisecond, like the background ADC scan
+}
+
+void DeviceDriverSet_Voltage::DeviceDriverSet_Voltage_Init(void) {}
+q16_t DeviceDriverSet_Voltage::DeviceDriverSet_Voltage_getAnalogue(void)
+{
+  return (q16_t)(HostCar.Voltage * 65536);
+}
+
+template <class Board>
+void DeviceDriverSet_Motor<Board>::DeviceDriverSet_Motor_Init(void)
+{
+  HostCar_STBY = false;
+}
+template <class Board>
+void DeviceDriverSet_Motor<Board>::DeviceDriverSet_Motor_control(boolean direction_A, uint8_t speed_A, boolean direction_B, uint8_t speed_B, boolean controlED)
+{
+  if (controlED == control_enable)
+  {
+    if (speed_A > 0 || speed_B > 0) //direction_void arrives as true in the boolean parameter, as in the real driver
+    {
+      Motor_RunMillis = millis();
+    }
+    HostCar_STBY = true;
+    HostCar_Output[0] = direction_A ? speed_A : -speed_A;
+    HostCar_Output[1] = direction_B ? speed_B : -speed_B;
+  }
+  else
+  {
+    HostCar_STBY = false;
+  }
+}
+
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Init(void) {}
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Update(void) {}
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Get(uint16_t *ULTRASONIC_Get)
+{
+  *ULTRASONIC_Get = ULTRASONIC_Distance_Max;
+}
+template <class Board>
+void DeviceDriverSet_ULTRASONIC<Board>::DeviceDriverSet_ULTRASONIC_Get(uint16_t *ULTRASONIC_Get, unsigned long *ULTRASONIC_Millis)
+{
+  *ULTRASONIC_Get = ULTRASONIC_Distance_Max;
+  *ULTRASONIC_Millis = millis();
+}
+
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_Init(unsigned int) {}
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_control(unsigned int) {}
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_controls(uint8_t, unsigned int) {}
+template <class Board>
+void DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_Update(void) {}
+template <class Board>
+bool DeviceDriverSet_Servo<Board>::DeviceDriverSet_Servo_InPosition(uint8_t)
+{
+  return true;
+}
+
+void DeviceDriverSet_IRrecv::DeviceDriverSet_IRrecv_Init(void) {}
+bool DeviceDriverSet_IRrecv::DeviceDriverSet_IRrecv_Get(uint8_t *)
+{
+  return false;
+}
+
+template class DeviceDriverSet_Key<DeviceDriverSet_Board>;
+template class DeviceDriverSet_ITR20001<DeviceDriverSet_Board>;
+template class DeviceDriverSet_Motor<DeviceDriverSet_Board>;
+template class DeviceDriverSet_ULTRASONIC<DeviceDriverSet_Board>;
+template class DeviceDriverSet_Servo<DeviceDriverSet_Board>;
+
+bool MPU6050_getdata::MPU6050_dveInit(void)
+{
+  Online = true;
+  return false;
+}
+bool MPU6050_getdata::MPU6050_dveUpdate(void)
+{
+  return false;
+}
+bool MPU6050_getdata::MPU6050_dveGetEulerAngles(q16_t *Yaw)
+{
+  *Yaw = agz = HostCar_Yaw;
+  return false;
+}
+bool MPU6050_getdata::MPU6050_dveGetAcceleration(int16_t *ax, int16_t *ay, int16_t *az)
+{
+  *ax = HostCar.Accel[0], *ay = HostCar.Accel[1], *az = HostCar.Accel[2];
+  return false;
+}
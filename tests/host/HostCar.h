@@ -0,0 +1,55 @@
+/*
+  Host car：a two-side skid steer model of the Smart Robot Car driven through simulated drivers, so the sketch's
+  ApplicationFunctionSet_xxx0.cpp runs unchanged against it (the drivers of DeviceDriverSet_xxx0.h and MPU6050_getdata
+  are defined in HostCar.cpp instead of the real ones).
+  Body frame：x forward, y left；HostCar_State::Heading is in degrees, clockwise positive like the gyro yaw.
+*/
+#ifndef _HostCar_H_
+#define _HostCar_H_
+#include <Arduino.h>
+
+struct HostCar_Params
+{
+  double Battery = 7.4;          //V, open circuit
+  double Battery_R = 0.3;        //Ohm
+  double Motor_R = 2.5;          //Ohm per side (two motors in parallel)
+  double Motor_k[2] = {0.25, 0.25}; //N·m/A per side at the wheel (A right, B left)
+  double Wheel_r = 0.033;        //m
+  double Wheel_J = 3e-4;         //kg·m² per side, motor inertia through the gearbox included
+  double Wheel_Friction = 0.035; //N·m per side, gearbox Coulomb friction (the dead band of the duty)
+  double Mass = 0.8;             //kg
+  double Inertia = 0.0042;       //kg·m² about the vertical axis
+  double Track = 0.12;           //m
+  double Grip[2] = {0.65, 0.65}; //Tyre friction coefficient per side
+  double Slip_Stiffness = 60;    //N per m/s of tyre slip
+  double Scrub = 0.18;           //N·m：sideways scrub of the four tyres when turning on the spot
+  double Gyro_Noise = 6;         //LSB rms at DLPF 42Hz
+};
+struct HostCar_State
+{
+  double X, Y, Heading;         //m, m, degrees clockwise
+  double Speed, YawRate;        //m/s, degrees/s clockwise
+  double Wheel_w[2];            //rad/s per side (A right, B left)
+  double Current, Voltage;      //Battery
+  int Duty[2];                  //Signed duty driven on each side (A right, B left)
+  double Current_Peak, Voltage_Min;
+  double Motors_Off_us;         //Time with both outputs off (STBY low or both duties 0)
+  int16_t Accel[3];             //Accelerometer as the MPU6050 reports it (16384 LSB per g)：level, +1g on Z, after a reset
+  bool Ir_Blind;                //IR sensors see nothing (car lifted, or a floor darker than TrackingDetection_V)
+};
+extern HostCar_Params HostCar_Param;
+extern HostCar_State HostCar;
+
+/*Line under the IR sensors：signed distance (m) from the centre of the tape, NULL for a plain floor*/
+extern double (*HostCar_Line)(double X, double Y);
+#define HostCar_Line_Width 0.018     //m：black tape
+#define HostCar_Sensor_Ahead 0.07    //m：IR sensors ahead of the axle
+#define HostCar_Sensor_Spacing 0.015 //m：between the IR sensors
+
+void HostCar_Reset(const HostCar_Params &Params);
+void HostCar_Step(unsigned long Micros);     //Physics in 100us steps, the clock moves along
+void HostCar_Setup(void);                    //setup() of the sketch
+void HostCar_Loop(unsigned long Micros);     //One pass of loop() of the sketch, then Micros of simulated time
+int HostCar_Ir(int Sensor);                  //0 L, 1 M, 2 R：what the ITR20001 sees now
+int16_t HostCar_GyroSample(void);            //One MPU6050 gyro Z reading now (131 LSB per °/s, counter-clockwise positive)
+#endif
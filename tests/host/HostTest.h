@@ -0,0 +1,22 @@
+/*
+  Host unit test helpers：Test_Expect counts a failure and prints the first 20 with their line.
+*/
+#ifndef _HostTest_H_
+#define _HostTest_H_
+#include <stdio.h>
+
+static int Test_Failures = 0;
+#define Test_Expect(Condition, ...)  \
+  do                                 \
+  {                                  \
+    if (!(Condition))                \
+    {                                \
+      if (Test_Failures++ < 20)      \
+      {                              \
+        printf("FAIL line %d：", __LINE__); \
+        printf(__VA_ARGS__);         \
+        printf("\n");                \
+      }                              \
+    }                                \
+  } while (0)
+#endif
@@ -0,0 +1,126 @@
+/*
+  loop() per-iteration cost (ApplicationFunctionSet_ModeDispatch)：
+  the always-on services followed by the mode dispatch, against the same services followed by the polling chain it
+  replaced, where every mode and N-command handler was called on each pass, compared Functional_Mode with its own mode
+  and reset its mode-local flags when it was not the active one (Legacy_*). The handler bodies are today's in both, so the
+  difference is the cost of the chain itself.
+  Each pass is timed on the host with the simulated car moving 1ms between passes；the figures are host ns (a relative
+  figure, not UNO cycles) and the number of handler calls per pass.
+*/
+#include <algorithm>
+#include <chrono> //Standard headers before the Arduino min/max macros
+#include "HostBench.h"
+#include "ApplicationFunctionSet_xxx0.cpp"
+#include "HostCar.h"
+
+#define Bench_Passes 20000
+#define Bench_Loop 1000 //us of simulated time between passes
+
+/*The polling chain before the change：one call per handler, in the order loop() made them*/
+static unsigned long Legacy_Calls = 0;
+static volatile bool Legacy_Idle[13]; //The "else" branch of each handler
+template <int Slot, SmartRobotCarFunctionalModel Mode, void (*Handler)(void)>
+__attribute__((noinline)) static void Legacy_Handler(void)
+{
+  Legacy_Calls++;
+  if (Application_SmartRobotCarxxx0.Functional_Mode == Mode)
+  {
+    Handler();
+  }
+  else
+  {
+    Legacy_Idle[Slot] = true;
+  }
+}
+static void Legacy_Follow(void) { Application_FunctionSet.ApplicationFunctionSet_Follow(); }
+static void Legacy_Obstacle(void) { Application_FunctionSet.ApplicationFunctionSet_Obstacle(); }
+static void Legacy_Tracking(void) { Application_FunctionSet.ApplicationFunctionSet_Tracking(); }
+static void Legacy_Rocker(void) { Application_FunctionSet.ApplicationFunctionSet_Rocker(); }
+static void Legacy_Standby(void) { Application_FunctionSet.ApplicationFunctionSet_Standby(); }
+static void Legacy_ServoControl(void) { Application_FunctionSet.CMD_ServoControl_xxx0(); }
+static void Legacy_MotorControl(void) { Application_FunctionSet.CMD_MotorControl_xxx0(); }
+static void Legacy_Queue(void) { Application_FunctionSet.CMD_Queue_xxx0(); }
+static void Legacy_Retired(void) {} //N2/N3/N4/N7/N8 handlers now served by the queue
+static void Legacy_ClearAllFunctions(void) { Application_FunctionSet.CMD_ClearAllFunctions_xxx0(); }
+static void Legacy_Loop(void)
+{
+  Application_FunctionSet.ApplicationFunctionSet_SensorDataUpdate();
+  Application_FunctionSet.ApplicationFunctionSet_KeyCommand();
+  Application_FunctionSet.ApplicationFunctionSet_RGB();
+  Legacy_Handler<0, Follow_mode, Legacy_Follow>();
+  Legacy_Handler<1, ObstacleAvoidance_mode, Legacy_Obstacle>();
+  Legacy_Handler<2, TraceBased_mode, Legacy_Tracking>();
+  Legacy_Handler<3, Rocker_mode, Legacy_Rocker>();
+  Legacy_Handler<4, Standby_mode, Legacy_Standby>();
+  Application_FunctionSet.ApplicationFunctionSet_IRrecv();
+  Application_FunctionSet.ApplicationFunctionSet_SerialPortDataAnalysis();
+  Legacy_Handler<5, CMD_ServoControl, Legacy_ServoControl>();
+  Legacy_Handler<6, CMD_MotorControl, Legacy_MotorControl>();
+  Legacy_Handler<7, CMD_Queue_mode, Legacy_Queue>();       //CMD_CarControlTimeLimit_xxx0
+  Legacy_Handler<8, CMD_Queue_mode, Legacy_Retired>();     //CMD_CarControlNoTimeLimit_xxx0
+  Legacy_Handler<9, CMD_Queue_mode, Legacy_Retired>();     //CMD_MotorControlSpeed_xxx0
+  Legacy_Handler<10, CMD_Queue_mode, Legacy_Retired>();    //CMD_LightingControlTimeLimit_xxx0
+  Legacy_Handler<11, CMD_Queue_mode, Legacy_Retired>();    //CMD_LightingControlNoTimeLimit_xxx0
+  Legacy_Handler<12, CMD_ClearAllFunctions_Standby_mode, Legacy_ClearAllFunctions>();
+  ApplicationFunctionSet_SmartRobotCarMotorShaper();
+}
+static void Dispatch_Loop(void)
+{
+  Application_FunctionSet.ApplicationFunctionSet_SensorDataUpdate();
+  Application_FunctionSet.ApplicationFunctionSet_KeyCommand();
+  Application_FunctionSet.ApplicationFunctionSet_RGB();
+  Application_FunctionSet.ApplicationFunctionSet_IRrecv();
+  Application_FunctionSet.ApplicationFunctionSet_SerialPortDataAnalysis();
+  Application_FunctionSet.ApplicationFunctionSet_ModeDispatch();
+}
+
+struct BenchResult
+{
+  double Mean_ns, Median_ns, P99_ns;
+};
+static BenchResult Bench_Run(SmartRobotCarFunctionalModel Mode, void (*Loop)(void))
+{
+  HostCar_Params Params;
+  HostCar_Reset(Params);
+  HostCar_Setup();
+  Application_SmartRobotCarxxx0.Functional_Mode = Mode;
+  HostCar_Loop(Bench_Loop); //Enter the mode
+  static double ns[Bench_Passes];
+  for (int i = 0; i < Bench_Passes; i++)
+  {
+    auto t0 = std::chrono::steady_clock::now();
+    Loop();
+    ns[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    HostCar_Step(Bench_Loop);
+  }
+  double sum = 0;
+  for (int i = 0; i < Bench_Passes; i++)
+  {
+    sum += ns[i];
+  }
+  std::sort(ns, ns + Bench_Passes);
+  BenchResult r = {sum / Bench_Passes, ns[Bench_Passes / 2], ns[Bench_Passes * 99 / 100]};
+  return r;
+}
+
+int main(void)
+{
+  const SmartRobotCarFunctionalModel Mode[] = {Standby_mode, TraceBased_mode, ObstacleAvoidance_mode, Follow_mode, Rocker_mode, CMD_Programming_mode};
+  const char *Name[] = {"Standby", "Tracking", "Obstacle", "Follow", "Rocker", "Programming"};
+  printf("%d passes per mode, %d us of simulated time between passes；host ns per pass (mean / median / 99th percentile)\n", Bench_Passes,
+         Bench_Loop);
+  double total[2] = {0, 0};
+  for (int m = 0; m < 6; m++)
+  {
+    BenchResult legacy = Bench_Run(Mode[m], Legacy_Loop);
+    BenchResult dispatch = Bench_Run(Mode[m], Dispatch_Loop);
+    total[0] += legacy.Median_ns;
+    total[1] += dispatch.Median_ns;
+    printf("  %-11s polling chain %7.1f / %7.1f / %7.1f   dispatch %7.1f / %7.1f / %7.1f\n", Name[m], legacy.Mean_ns, legacy.Median_ns,
+           legacy.P99_ns, dispatch.Mean_ns, dispatch.Median_ns, dispatch.P99_ns);
+  }
+  printf("  handler calls per pass：polling chain %lu, dispatch 1\n", Legacy_Calls / (6UL * Bench_Passes));
+  printf("  median over the modes：polling chain %.1f ns, dispatch %.1f ns (%+.1f%%)\n", total[0] / 6, total[1] / 6,
+         100.0 * (total[1] - total[0]) / total[0]);
+  return 0;
+}
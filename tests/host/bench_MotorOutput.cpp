@@ -0,0 +1,86 @@
+/*
+  TB6612 output benchmark (DeviceDriverSet_Motor_control / DeviceDriverSet_Motor_Output)：
+  the host port of DeviceDriverSet_Motor_Benchmark (_Test_DeviceDriverSet), the real driver of DeviceDriverSet_xxx0.cpp
+  against the Arduino-call path it replaced (Legacy_*), 1000 calls with the same command repeated and 1000 with two
+  commands alternating. On the host both reach the pins through digitalWrite()/analogWrite(), so the figure is the
+  outputs written per call：each is one Arduino call before, and one sbi/cbi or OCR0x store on the ATmega328P now.
+  The pins are compared after every call：both paths must leave the TB6612 in the same state.
+*/
+#include "HostBench.h"
+#include "DeviceDriverSet_xxx0.cpp"
+
+#define Bench_Calls 1000
+
+/*The Arduino-call path before the change*/
+template <class Board>
+static void Legacy_Motor_control(boolean direction_A, uint8_t speed_A, boolean direction_B, uint8_t speed_B)
+{
+  digitalWrite(Board::PIN_Motor_STBY, HIGH);
+  digitalWrite(Board::PIN_Motor_AIN_1, (direction_A == direction_just) ? HIGH : LOW);
+  analogWrite(Board::PIN_Motor_PWMA, speed_A);
+  digitalWrite(Board::PIN_Motor_BIN_1, (direction_B == direction_just) ? HIGH : LOW);
+  analogWrite(Board::PIN_Motor_PWMB, speed_B);
+}
+
+struct BenchCommand
+{
+  boolean direction_A;
+  uint8_t speed_A;
+  boolean direction_B;
+  uint8_t speed_B;
+};
+static int Bench_Mismatches = 0;
+template <class Board>
+static void Bench_Pins(uint8_t *Pins)
+{
+  const uint8_t Pin[5] = {Board::PIN_Motor_STBY, Board::PIN_Motor_AIN_1, Board::PIN_Motor_PWMA, Board::PIN_Motor_BIN_1, Board::PIN_Motor_PWMB};
+  for (int i = 0; i < 5; i++)
+  {
+    Pins[i] = HostArduino_Pin[Pin[i]];
+  }
+}
+/*Outputs written per call, before and now, over the commands in turn*/
+template <class Board>
+static void Bench_Run(const char *Name, const BenchCommand *Commands, int Count)
+{
+  DeviceDriverSet_Motor<Board> Motor;
+  memset(HostArduino_Pin, 0, sizeof(HostArduino_Pin));
+  Motor.DeviceDriverSet_Motor_Init();
+  unsigned long writes[2] = {0, 0};
+  for (int i = 0; i < Bench_Calls; i++)
+  {
+    const BenchCommand &c = Commands[i % Count];
+    uint8_t pins[2][5];
+    unsigned long start = HostArduino_PinWrites;
+    Legacy_Motor_control<Board>(c.direction_A, c.speed_A, c.direction_B, c.speed_B);
+    writes[0] += HostArduino_PinWrites - start;
+    Bench_Pins<Board>(pins[0]);
+    start = HostArduino_PinWrites;
+    Motor.DeviceDriverSet_Motor_control(c.direction_A, c.speed_A, c.direction_B, c.speed_B, control_enable);
+    writes[1] += HostArduino_PinWrites - start;
+    Bench_Pins<Board>(pins[1]);
+    Bench_Mismatches += (0 != memcmp(pins[0], pins[1], sizeof(pins[0])));
+  }
+  printf("  %-12s Arduino calls %.2f  outputs written %.2f  per call\n", Name, (double)writes[0] / Bench_Calls, (double)writes[1] / Bench_Calls);
+}
+template <class Board>
+static void Bench_Board(const char *Name)
+{
+  const BenchCommand Repeated[] = {{direction_just, 20, direction_just, 20}};
+  const BenchCommand Alternating[] = {{direction_back, 40, direction_just, 20}, {direction_just, 20, direction_back, 40}};
+  const BenchCommand Modes[] = {{direction_just, 150, direction_just, 150}, {direction_just, 150, direction_just, 150},
+                                {direction_back, 150, direction_just, 150}, {direction_back, 0, direction_just, 0},
+                                {direction_just, 0, direction_just, 0}, {direction_just, 255, direction_just, 255}};
+  printf(" %s\n", Name);
+  Bench_Run<Board>("repeated", Repeated, 1);
+  Bench_Run<Board>("alternating", Alternating, 2);
+  Bench_Run<Board>("mixed", Modes, sizeof(Modes) / sizeof(Modes[0]));
+}
+
+int main(void)
+{
+  printf("%d calls per sequence\n", Bench_Calls);
+  Bench_Board<DeviceDriverSet_Board>("DeviceDriverSet_Board");
+  printf("  pin state mismatches %d\n", Bench_Mismatches);
+  return Bench_Mismatches ? 1 : 0;
+}
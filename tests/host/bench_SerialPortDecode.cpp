@@ -0,0 +1,109 @@
+/*
+  Command decoder benchmark (ApplicationFunctionSet_SerialPortDecode)：
+  the fixed-schema decoder against the deserializeJson path it replaced (StaticJsonDocument<200> from the vendored
+  ArduinoJson-v6.11.1.h, reading N, H, D1~D4 and T the way the old SerialPortDataAnalysis did).
+  Every corpus frame and a set of awkward frames must decode to the same command both ways；
+  then both decode the corpus repeatedly for host time per frame (a relative figure, not UNO cycles).
+*/
+#include <chrono> //Standard headers before the Arduino min/max macros
+#define ARDUINOJSON_ENABLE_STD_STRING 0
+#define ARDUINOJSON_ENABLE_STD_STREAM 0
+#define ARDUINOJSON_USE_DOUBLE 0 //As on the UNO
+#define ARDUINOJSON_USE_LONG_LONG 0
+#include "ArduinoJson-v6.11.1.h" //Before Arduino.h：the library's own types, no String/Stream glue
+#include "HostBench.h"
+#include "ApplicationFunctionSet_xxx0.cpp"
+
+/*The decoder before the change：StaticJsonDocument<200> holds 25 slots of 8 B on the UNO, give it as many host slots*/
+#define Legacy_Capacity (200 + 25 * (sizeof(ARDUINOJSON_NAMESPACE::VariantSlot) - 8))
+static boolean Legacy_SerialPortDecode(const char *p, SerialPortCommand *Command)
+{
+  StaticJsonDocument<Legacy_Capacity> doc;
+  DeserializationError error = deserializeJson(doc, p);
+  memset(Command, 0, sizeof(SerialPortCommand));
+  if (error)
+  {
+    return false;
+  }
+  Command->N = doc["N"].as<long>();
+  Command->D1 = doc["D1"].as<long>();
+  Command->D2 = doc["D2"].as<long>();
+  Command->D3 = doc["D3"].as<long>();
+  Command->D4 = doc["D4"].as<long>();
+  Command->T = doc["T"].as<long>();
+  const char *H = doc["H"];
+  if (H != NULL)
+  {
+    strncpy(Command->H, H, SerialPortCommand_H_Max);
+  }
+  return true;
+}
+
+static const char *const Decode_Awkward[] = {
+    "{}",
+    " { \"N\" : 3 ,\t\"D1\":1,\r\n\"D2\": 200 } ",
+    "{\"D2\":200,\"N\":3,\"D1\":1}",
+    "{\"N\":3.7,\"D1\":-2,\"D2\":1e2}",
+    "{\"D1\":1.5e1,\"D2\":25e-1,\"D3\":-7.9,\"D4\":0.5E+2,\"T\":2E3}",
+    "{\"N\":5,\"D1\":true,\"D2\":false,\"D3\":null}",
+    "{\"H\":\"a\\\"b\",\"N\":21}",
+    "{\"H\":7,\"N\":21}",
+    "{\"X\":{\"a\":[1,2,{\"b\":\"}\"}]},\"N\":100}",
+    "{\"DD\":5,\"D5\":6,\"n\":7,\"N\":8}",
+    "{\"H\":\"0123456789abcdef\",\"N\":1}",
+    "{\"N\":2,\"T\":65535}",
+    "{Heartbeat}",
+    "{\"N\":}",
+    "{\"N\":3,}",
+    "{\"N\" 3}",
+    "{\"N\":3",
+};
+static bool Decode_Same(const char *Frame)
+{
+  SerialPortCommand a, b;
+  boolean ok_a = Legacy_SerialPortDecode(Frame, &a);
+  boolean ok_b = ApplicationFunctionSet_SerialPortDecode(Frame, &b);
+  if (ok_a != ok_b || (ok_a && (a.N != b.N || a.D1 != b.D1 || a.D2 != b.D2 || a.D3 != b.D3 || a.D4 != b.D4 || a.T != b.T || strcmp(a.H, b.H) != 0)))
+  {
+    printf("  MISMATCH %s：deserializeJson %d N%u D%d,%d,%d,%d T%lu H\"%s\" / decoder %d N%u D%d,%d,%d,%d T%lu H\"%s\"\n", Frame,
+           ok_a, a.N, a.D1, a.D2, a.D3, a.D4, (unsigned long)a.T, a.H, ok_b, b.N, b.D1, b.D2, b.D3, b.D4, (unsigned long)b.T, b.H);
+    return false;
+  }
+  return true;
+}
+static double Decode_Time(boolean (*Decode)(const char *, SerialPortCommand *), const std::vector<std::string> &Frames, int Repeat)
+{
+  SerialPortCommand Command;
+  volatile unsigned long Sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < Repeat; i++)
+  {
+    for (const std::string &f : Frames)
+    {
+      Sink += Decode(f.c_str(), &Command) + Command.N;
+    }
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / ((double)Frames.size() * Repeat);
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<std::string> Frames = HostBench_Corpus((argc > 1) ? argv[1] : "corpus/AppFrames.txt");
+  int Mismatch = 0;
+  for (const std::string &f : Frames)
+  {
+    Mismatch += !Decode_Same(f.c_str());
+  }
+  for (const char *f : Decode_Awkward)
+  {
+    Mismatch += !Decode_Same(f);
+  }
+  printf("Same command from both：%zu corpus + %zu awkward frames, %d mismatches\n", Frames.size(), sizeof(Decode_Awkward) / sizeof(Decode_Awkward[0]), Mismatch);
+
+  const int Repeat = 50000;
+  double Legacy = Decode_Time(Legacy_SerialPortDecode, Frames, Repeat);
+  double Fixed = Decode_Time(ApplicationFunctionSet_SerialPortDecode, Frames, Repeat);
+  printf("Decode time (host)：deserializeJson %.1f ns/frame, decoder %.1f ns/frame (%.1fx)\n", Legacy, Fixed, Legacy / Fixed);
+  printf("Per frame state：StaticJsonDocument<200> (200 B pool on the UNO) against SerialPortCommand %zu B\n", sizeof(SerialPortCommand));
+  return Mismatch ? 1 : 0;
+}
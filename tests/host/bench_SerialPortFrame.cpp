@@ -0,0 +1,96 @@
+/*
+  Serial frame receiver benchmark (ApplicationFunctionSet_SerialPortFrame)：
+  the fixed frame buffer against the String receiver it replaced, fed the frames of corpus/AppFrames.txt.
+  Reports frames, heap calls and heap growth of each, host time per byte (a relative figure, not UNO cycles),
+  and what a stream of garbage without a '}' costs each of them.
+*/
+#include <chrono> //Standard headers before the Arduino min/max macros
+#include "HostBench.h"
+#include "ApplicationFunctionSet_xxx0.cpp"
+
+/*The receiver before the change：one '}' terminated frame per call, grown a byte at a time*/
+static String Legacy_SerialPortData = "";
+static unsigned int Legacy_FrameLength = 0;
+static bool Legacy_SerialPortFrame(void)
+{
+  uint8_t c = 0;
+  while (c != '}' && Serial.available() > 0)
+  {
+    c = Serial.read();
+    Legacy_SerialPortData += (char)c;
+  }
+  if (c == '}')
+  {
+    Legacy_FrameLength = Legacy_SerialPortData.length();
+    Legacy_SerialPortData = ""; //Keeps the capacity, as WString::copy does
+    return true;
+  }
+  return false;
+}
+static bool Fixed_SerialPortFrame(void)
+{
+  return SerialPortFrame_None != ApplicationFunctionSet_SerialPortFrame();
+}
+
+struct BenchResult
+{
+  unsigned long Frames;
+  unsigned long Allocations;
+  long Peak;
+  double ns_per_byte;
+};
+static BenchResult Bench_Run(bool (*Frame)(void), const std::string &Stream, int Repeat)
+{
+  BenchResult r = {0, 0, 0, 0};
+  HostHeap::Reset();
+  double ns = 0;
+  for (int i = 0; i < Repeat; i++)
+  {
+    Serial.Feed(Stream.data(), Stream.size());
+    auto t0 = std::chrono::steady_clock::now();
+    while (Serial.available() > 0)
+    {
+      r.Frames += Frame();
+    }
+    ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  }
+  r.Allocations = HostHeap::Allocations;
+  r.Peak = HostHeap::Peak;
+  r.ns_per_byte = ns / ((double)Stream.size() * Repeat);
+  return r;
+}
+static void Bench_Print(const char *Name, const BenchResult &r)
+{
+  printf("  %-8s frames %8lu  heap calls %6lu  heap growth %5ld B  %6.2f ns/byte\n", Name, r.Frames, r.Allocations, r.Peak, r.ns_per_byte);
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<std::string> Frames = HostBench_Corpus((argc > 1) ? argv[1] : "corpus/AppFrames.txt");
+  std::string Stream;
+  for (const std::string &f : Frames)
+  {
+    Stream += f;
+  }
+  const int Repeat = 20000;
+  printf("Corpus：%zu frames, %zu bytes, replayed %d times\n", Frames.size(), Stream.size(), Repeat);
+  BenchResult Legacy = Bench_Run(Legacy_SerialPortFrame, Stream, Repeat);
+  BenchResult Fixed = Bench_Run(Fixed_SerialPortFrame, Stream, Repeat);
+  Bench_Print("String", Legacy);
+  Bench_Print("Fixed", Fixed);
+
+  /*Line noise：2000 bytes with no '}' (a wrong baud rate, a half-plugged camera board), then one good frame*/
+  std::string Noise(2000, 'x');
+  Noise[0] = '{';
+  Noise += Frames[0];
+  Legacy_SerialPortData = "";
+  BenchResult LegacyNoise = Bench_Run(Legacy_SerialPortFrame, Noise, 1);
+  BenchResult FixedNoise = Bench_Run(Fixed_SerialPortFrame, Noise, 1);
+  printf("Noise：2000 bytes without '}' then one frame\n");
+  Bench_Print("String", LegacyNoise);
+  Bench_Print("Fixed", FixedNoise);
+  printf("  String hands over one %u byte frame：the good frame is lost with the noise\n", Legacy_FrameLength);
+  printf("  Fixed buffer：%u B static, oversized frames counted %u\n", (unsigned)sizeof(SerialPortData), SerialPortData_Oversized);
+
+  return (Fixed.Frames == (unsigned long)Frames.size() * Repeat && Fixed.Allocations == 0 && FixedNoise.Frames == 1) ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/*
+  UNO link benchmark (SerialPortLink_*, SerialPortTx_*)：
+  the stub's Serial with the timed wire, loop() run every Bench_Loop us.
+  - Command round trip of N 21 (ultrasonic distance) at 9600, where both ends stayed before the change, and at each rate
+    N 25/N 26 negotiate after it：from the first request byte on the wire to the last reply byte off it.
+  - A burst of replies larger than the core's 64-byte TX buffer：time loop() is held up writing it, written with
+    Serial.print as before the change (Legacy_*) and through the TX ring.
+*/
+#include "HostBench.h"
+#include "ApplicationFunctionSet_xxx0.cpp"
+#include "HostCar.h"
+
+#define Bench_Loop 1000       //us per pass of loop()
+#define Bench_Queries 50      //Round trips per rate
+#define Bench_Timeout 1000000 //us
+
+/*The frame, fed at the current rate, until Reply (a prefix) is complete in Tx；-1 on a timeout*/
+static long Bench_RoundTrip(const char *Frame, const char *Reply)
+{
+  size_t from = Serial.Tx.size();
+  unsigned long start = micros();
+  Serial.Feed(Frame);
+  while (micros() - start < Bench_Timeout)
+  {
+    HostCar_Loop(Bench_Loop);
+    size_t at = Serial.Tx.find(Reply, from);
+    if (at != std::string::npos && Serial.Tx.find('}', at) != std::string::npos)
+    {
+      return (long)(Serial.Tx_Done_us - start);
+    }
+  }
+  return -1;
+}
+/*N 25 at the current rate, then the N 26 probe at the new one, as the ESP32 bridge steps up*/
+static bool Bench_Negotiate(uint8_t Index)
+{
+  char frame[48], reply[16];
+  sprintf(frame, "{\"H\":\"L\",\"N\":25,\"D1\":%u}", Index);
+  if (Bench_RoundTrip(frame, "{L_ok}") < 0)
+  {
+    return false;
+  }
+  uint8_t crc = SerialPortBinary_CRC8((const uint8_t *)"P", 1);
+  sprintf(frame, "{\"H\":\"P\",\"N\":26,\"D1\":%u}", crc);
+  sprintf(reply, "{P_%u}", crc);
+  return Bench_RoundTrip(frame, reply) >= 0 && Serial.Baud == SerialPortLink_Rate[Index];
+}
+static void Bench_Queries_Run(void)
+{
+  long sum = 0, worst = 0;
+  Serial.flush();
+  for (int i = 0; i < Bench_Queries; i++)
+  {
+    long us = Bench_RoundTrip("{\"H\":\"Q\",\"N\":21,\"D1\":2}", "{Q_");
+    if (us < 0)
+    {
+      printf("  %6lu baud：no reply\n", Serial.Baud);
+      exit(1);
+    }
+    sum += us;
+    worst = max(worst, us);
+    HostCar_Loop(Bench_Loop);
+  }
+  printf("  %6lu baud：round trip %6.2f ms average, %6.2f ms worst\n", Serial.Baud, sum / 1000.0 / Bench_Queries, worst / 1000.0);
+}
+
+/*Six 20-byte replies in one pass：before, each Serial.print waited for room in the core's buffer*/
+#define Bench_Burst 6
+static const char Bench_BurstReply[] = "{123_ok_10_20_30_40}";
+static void Legacy_Burst(void)
+{
+  for (int i = 0; i < Bench_Burst; i++)
+  {
+    Serial.print(Bench_BurstReply);
+  }
+}
+static void Ring_Burst(void)
+{
+  for (int i = 0; i < Bench_Burst; i++)
+  {
+    SerialPortTx_Print(Bench_BurstReply, true);
+  }
+}
+static void Bench_Burst_Run(const char *Name, void (*Burst)(void))
+{
+  HostCar_Loop(Bench_Loop);
+  Serial.flush();
+  SerialPortTx_Flush();
+  unsigned long start = micros();
+  unsigned long blocked = Serial.Tx_Blocked_us;
+  Burst();
+  unsigned long stall = Serial.Tx_Blocked_us - blocked;
+  while (SerialPortTx_Tail != SerialPortTx_Head) //Later passes：the ring tops up the core's buffer
+  {
+    blocked = Serial.Tx_Blocked_us;
+    HostCar_Loop(Bench_Loop);
+    stall = max(stall, Serial.Tx_Blocked_us - blocked);
+  }
+  printf("    %-12s loop() held up %6.2f ms, last byte out after %6.2f ms\n", Name, stall / 1000.0, (Serial.Tx_Done_us - start) / 1000.0);
+}
+
+int main(void)
+{
+  HostCar_Params Params;
+  HostCar_Reset(Params);
+  HostCar_Setup();
+  Serial.Timed = true;
+  printf("loop() every %d us；%d queries per rate\n", Bench_Loop, Bench_Queries);
+  printf(" Reply burst：%d x %u bytes\n", Bench_Burst, (unsigned)strlen(Bench_BurstReply));
+  printf("  %6lu baud\n", Serial.Baud);
+  Bench_Burst_Run("Serial.print", Legacy_Burst);
+  Bench_Burst_Run("TX ring", Ring_Burst);
+  printf(" Command round trip (N 21)\n");
+  Bench_Queries_Run();
+  for (uint8_t i = 1; i < sizeof(SerialPortLink_Rate) / sizeof(SerialPortLink_Rate[0]); i++)
+  {
+    if (false == Bench_Negotiate(i))
+    {
+      printf("  %6lu baud：negotiation failed\n", (unsigned long)SerialPortLink_Rate[i]);
+      return 1;
+    }
+    Bench_Queries_Run();
+  }
+  printf(" Reply burst after the negotiation\n");
+  printf("  %6lu baud\n", Serial.Baud);
+  Bench_Burst_Run("Serial.print", Legacy_Burst);
+  Bench_Burst_Run("TX ring", Ring_Burst);
+  return 0;
+}
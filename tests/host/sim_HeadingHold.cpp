@@ -0,0 +1,120 @@
+/*
+  Heading hold simulation (ApplicationFunctionSet_SmartRobotCarLinearMotionControl)：
+  the Q16 PID that runs on the FIFO yaw against the P control it replaced, which stopped both motors every 10ms to read
+  the gyro (one getRotationZ() sample over I2C, Sim_I2C_us with the motors off) and integrated that single sample.
+  Both drive the simulated car (HostCar) straight for Sim_Drive ms with the right side Sim_Asymmetry weaker；reported
+  are the heading at the end, the largest heading error on the way, the sideways drift, the distance and the time the
+  motors spent off while driving.
+*/
+#include "HostBench.h" //Standard headers before the Arduino min/max macros
+#include "ApplicationFunctionSet_xxx0.cpp"
+#include "HostCar.h"
+
+#define Sim_Drive 5000    //ms
+#define Sim_Loop 1000     //us per pass of loop()
+#define Sim_I2C_us 500    //One gyro register read at 100kHz I2C
+#define Sim_Asymmetry 0.9 //Right side motor constant
+
+/*The heading hold before the change*/
+static float Legacy_agz = 0;
+static unsigned long Legacy_lastTime = 0;
+static void Legacy_GetYaw(float *Yaw)
+{
+  unsigned long now = millis();
+  float dt = (now - Legacy_lastTime) / 1000.0;
+  Legacy_lastTime = now;
+  float gyroz = -HostCar_GyroSample() / 131.0 * dt;
+  if (fabs(gyroz) < 0.05)
+  {
+    gyroz = 0.00;
+  }
+  Legacy_agz += gyroz;
+  *Yaw = Legacy_agz;
+}
+static void Legacy_LinearMotionControl(uint8_t speed, uint8_t Kp, uint8_t UpperLimit)
+{
+  static float Yaw;
+  static float yaw_So = 0;
+  static uint8_t en = 110;
+  static unsigned long is_time;
+  unsigned long spent = 0;
+  if (en != 1 || millis() - is_time > 10)
+  {
+    AppMotor.DeviceDriverSet_Motor_control(direction_void, 0, direction_void, 0, control_enable);
+    HostCar_Step(Sim_I2C_us);
+    spent = Sim_I2C_us;
+    Legacy_GetYaw(&Yaw);
+    is_time = millis();
+  }
+  if (en != 1)
+  {
+    en = 1;
+    yaw_So = Yaw;
+  }
+  int R = constrain((int)((Yaw - yaw_So) * Kp + speed), 10, (int)UpperLimit);
+  int L = constrain((int)((yaw_So - Yaw) * Kp + speed), 10, (int)UpperLimit);
+  AppMotor.DeviceDriverSet_Motor_control(direction_just, R, direction_just, L, control_enable);
+  HostCar_Step(Sim_Loop - spent);
+}
+
+struct SimResult
+{
+  double Heading;     //deg at the end
+  double Heading_Max; //deg, largest |error|
+  double Drift_mm;    //Sideways
+  double Distance_m;
+  double Off_ms;      //Motors off while driving
+};
+static SimResult Sim_Run(bool Legacy, const char *Command, uint8_t Speed, uint8_t Kp, uint8_t UpperLimit, double Asymmetry)
+{
+  HostCar_Params Params;
+  Params.Motor_k[0] *= Asymmetry;
+  HostCar_Reset(Params);
+  HostCar_Setup();
+  for (int i = 0; i < 1500; i++) //Power up, gyro still
+  {
+    HostCar_Loop(Sim_Loop);
+  }
+  Legacy_lastTime = millis();
+  Legacy_agz = 0;
+  if (false == Legacy)
+  {
+    Serial.Feed(Command);
+  }
+  SimResult r = {0, 0, 0, 0, 0};
+  double off = HostCar.Motors_Off_us;
+  unsigned long start = millis();
+  while (millis() - start < Sim_Drive)
+  {
+    if (Legacy)
+      Legacy_LinearMotionControl(Speed, Kp, UpperLimit);
+    else
+      HostCar_Loop(Sim_Loop);
+    r.Heading_Max = max(r.Heading_Max, fabs(HostCar.Heading));
+  }
+  r.Heading = HostCar.Heading;
+  r.Drift_mm = HostCar.Y * 1000;
+  r.Distance_m = HostCar.X;
+  r.Off_ms = (HostCar.Motors_Off_us - off) / 1000;
+  return r;
+}
+static void Sim_Print(const char *Name, const SimResult &r)
+{
+  printf("  %-12s heading %+6.2f deg (max %5.2f)  drift %+7.1f mm  distance %5.2f m  motors off %6.1f ms\n", Name, r.Heading, r.Heading_Max,
+         r.Drift_mm, r.Distance_m, r.Off_ms);
+}
+
+int main(void)
+{
+  for (double Asymmetry : {1.0, Sim_Asymmetry})
+  {
+    printf("Right motor constant x%.2f, %d ms straight\n", Asymmetry, Sim_Drive);
+    printf(" Cruise (N3 forward 150；old Kp 2, limit 180)\n");
+    Sim_Print("stop+sample", Sim_Run(true, NULL, 150, 2, 180, Asymmetry));
+    Sim_Print("PID", Sim_Run(false, "{\"H\":\"1\",\"N\":3,\"D1\":3,\"D2\":150}", 150, 2, 180, Asymmetry));
+    printf(" Rocker (N102 forward 200；old Kp 10, limit 255)\n");
+    Sim_Print("stop+sample", Sim_Run(true, NULL, 200, 10, 255, Asymmetry));
+    Sim_Print("PID", Sim_Run(false, "{\"N\":102,\"D1\":1,\"D2\":200}", 200, 10, 255, Asymmetry));
+  }
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+  Lift detection simulation (ApplicationFunctionSet_SmartRobotCarLeaveTheGround)：
+  accelerometer and IR traces of a car driving over bumps on a white and on a dark (IR blind) floor, picked up level,
+  tipped on its side and found upside down, run through the detector and through the scoring it replaced, where any
+  bump in the last second counted whatever the IR did and the tilt test ignored the sign of Z (Legacy_*).
+  Reported are the time the car counted as lifted and the delay from the event to the first detection.
+*/
+#include "HostBench.h" //Standard headers before the Arduino min/max macros
+#include "ApplicationFunctionSet_xxx0.cpp"
+#include "HostCar.h"
+
+#define Sim_Loop 1000  //us per pass of loop()
+#define Sim_Time 4000  //ms
+#define Sim_Event 1000 //ms：pick up / tip over
+#define Sim_g 16384    //LSB
+#define Legacy_Bump 205      //1/1024 g
+#define Legacy_BumpHold 1000 //ms
+
+/*The scoring before the change*/
+static uint8_t Legacy_Confidence = 0;
+static bool Legacy_LeaveTheGround = true;
+static void Legacy_LeaveTheGroundUpdate(void)
+{
+  static unsigned long millis_last = 0;
+  static unsigned long BumpMillis = 0;
+  static bool Bumped = false;
+  if (millis() - millis_last < LeaveTheGround_Period)
+  {
+    return;
+  }
+  millis_last = millis();
+  uint8_t score = 0;
+  bool ir = HostCar.Ir_Blind;
+  long x = HostCar.Accel[0] >> 4, y = HostCar.Accel[1] >> 4, z = HostCar.Accel[2] >> 4;
+  long g2 = x * x + y * y + z * z;
+  if (labs(labs(z) - 1024) > Legacy_Bump)
+  {
+    Bumped = true;
+    BumpMillis = millis();
+  }
+  else if (millis() - BumpMillis > Legacy_BumpHold)
+  {
+    Bumped = false;
+  }
+  score += ir ? 50 : 0;
+  score += Bumped ? 30 : 0;
+  score += (z * z * 3 < g2 * 2) ? 70 : 0;
+  score += (g2 < 512L * 512L) ? 100 : 0;
+  score = min(score, (uint8_t)100);
+  Legacy_Confidence = (Legacy_Confidence + score + 1) / 2;
+  if (Legacy_Confidence >= LeaveTheGround_On)
+    Legacy_LeaveTheGround = false;
+  else if (Legacy_Confidence <= LeaveTheGround_Off)
+    Legacy_LeaveTheGround = true;
+}
+
+enum SimCase
+{
+  Sim_WhiteBumps, //Driving over bumps (±0.3g for 30ms every 110ms)
+  Sim_DarkBumps,  //The same, onto a floor darker than TrackingDetection_V at the event
+  Sim_PickUp,     //Lifted level：+0.4g for 150ms, IR blind from 50ms on, then held still
+  Sim_Side,       //Tipped on its side over 300ms, the IR still sees the floor
+  Sim_UpsideDown, //Found upside down (turned over between two samples), IR blind
+};
+static void Sim_Trace(SimCase Case, unsigned long t)
+{
+  HostCar.Accel[0] = HostCar.Accel[1] = 0;
+  HostCar.Accel[2] = Sim_g;
+  HostCar.Ir_Blind = false;
+  unsigned long e = t - Sim_Event; //Since the event (wraps before it)
+  switch (Case)
+  {
+  case Sim_DarkBumps:
+    HostCar.Ir_Blind = (t >= Sim_Event);
+  case Sim_WhiteBumps:
+    if (t % 110 < 30)
+      HostCar.Accel[2] = (t % 220 < 110) ? Sim_g * 13 / 10 : Sim_g * 7 / 10;
+    break;
+  case Sim_PickUp:
+    if (t >= Sim_Event)
+    {
+      HostCar.Accel[2] = (e < 150) ? Sim_g * 14 / 10 : Sim_g;
+      HostCar.Ir_Blind = (e >= 50);
+    }
+    break;
+  case Sim_Side:
+    if (t >= Sim_Event)
+    {
+      double a = min(e, 300UL) / 300.0 * M_PI / 2;
+      HostCar.Accel[1] = (int16_t)(Sim_g * sin(a));
+      HostCar.Accel[2] = (int16_t)(Sim_g * cos(a));
+    }
+    break;
+  case Sim_UpsideDown:
+    if (t >= Sim_Event)
+    {
+      HostCar.Accel[2] = -Sim_g;
+      HostCar.Ir_Blind = true;
+    }
+    break;
+  }
+}
+struct SimResult
+{
+  unsigned long Lifted_ms; //Time counted as lifted
+  long Detect_ms;          //From the event to the first detection (negative：before it)
+};
+static void Sim_Run(SimCase Case, SimResult *Result, SimResult *Legacy)
+{
+  HostCar_Params Params;
+  HostCar_Reset(Params);
+  HostCar_Setup();
+  Application_FunctionSet.Car_LeaveTheGround_Confidence = 0;
+  Application_FunctionSet.Car_LeaveTheGround = true;
+  Legacy_Confidence = 0;
+  Legacy_LeaveTheGround = true;
+  *Result = *Legacy = {0, 0};
+  unsigned long start = millis();
+  while (millis() - start < Sim_Time)
+  {
+    unsigned long t = millis() - start;
+    Sim_Trace(Case, t);
+    HostCar_Loop(Sim_Loop);
+    Legacy_LeaveTheGroundUpdate();
+    SimResult *r[2] = {Result, Legacy};
+    bool lifted[2] = {false == Application_FunctionSet.Car_LeaveTheGround, false == Legacy_LeaveTheGround};
+    for (int i = 0; i < 2; i++)
+    {
+      if (lifted[i])
+      {
+        r[i]->Lifted_ms++;
+        if (r[i]->Lifted_ms == 1)
+          r[i]->Detect_ms = (long)t - Sim_Event;
+      }
+    }
+  }
+}
+
+static const char *Sim_First(const SimResult &r, char *Text)
+{
+  if (r.Lifted_ms == 0)
+    return "never";
+  sprintf(Text, "%+ld ms", r.Detect_ms);
+  return Text;
+}
+int main(void)
+{
+  const char *Name[] = {"white floor, bumps", "dark floor, bumps", "picked up level", "tipped on its side", "upside down"};
+  printf("%d ms per case, the event at %d ms；lifted time, first detection after the event\n", Sim_Time, Sim_Event);
+  for (int c = Sim_WhiteBumps; c <= Sim_UpsideDown; c++)
+  {
+    SimResult r, legacy;
+    Sim_Run((SimCase)c, &r, &legacy);
+    char text[2][24];
+    printf("  %-20s before：lifted %4lu ms, first %-9s now：lifted %4lu ms, first %s\n", Name[c], legacy.Lifted_ms,
+           Sim_First(legacy, text[0]), r.Lifted_ms, Sim_First(r, text[1]));
+  }
+  return 0;
+}
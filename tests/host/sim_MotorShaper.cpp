@@ -0,0 +1,182 @@
+/*
+  Motor setpoint shaper simulation (ApplicationFunctionSet_SmartRobotCarMotorShaper)：
+  the same duty sequences driven on the simulated car (HostCar) once stepped straight into DeviceDriverSet_Motor_control,
+  as every mode did before the change, and once through ApplicationFunctionSet_SmartRobotCarMotorSetpoint and the shaper
+  with the limits of the mode. The left tyres grip better than the right ones (Sim_Grip_A/Sim_Grip_B), so a slipping
+  start turns the car；reported are the heading, the peak battery current and the lowest battery voltage.
+  The Obstacle back-off and turn (Backward 150 for Obstacle_BackOff_Time, Right 150 for Obstacle_Turn_Time, then Forward)
+  are run stepped as the blocking version drove them, shaped, and through ApplicationFunctionSet_SmartRobotCarMotionStep
+  as the state machine drives them now.
+  Then the emergency stop bypass, and the settling of the shaper alone on random targets for every limit set.
+*/
+#include <random> //Before the Arduino min/max macros
+#include "HostBench.h"
+#include "ApplicationFunctionSet_xxx0.cpp"
+#include "HostCar.h"
+
+#define Sim_Loop 1000  //us per pass of loop()
+#define Sim_Grip_A 0.55 //Right side
+#define Sim_Grip_B 0.65 //Left side
+#define Sim_Targets 2000
+
+struct SimStep
+{
+  unsigned long Start_ms;
+  int16_t A, B; //Signed duty, A right, B left
+};
+struct SimResult
+{
+  double Heading;      //deg at the end
+  double Current_Peak; //A
+  double Voltage_Min;  //V
+  double Distance_m;
+};
+static void Sim_Drive(int16_t A, int16_t B, bool Shaped)
+{
+  if (Shaped)
+  {
+    ApplicationFunctionSet_SmartRobotCarMotorSetpoint(/*direction_A*/ (A >= 0) ? direction_just : direction_back, /*speed_A*/ abs(A),
+                                                      /*direction_B*/ (B >= 0) ? direction_just : direction_back, /*speed_B*/ abs(B), /*controlED*/ control_enable);
+    ApplicationFunctionSet_SmartRobotCarMotorShaper();
+  }
+  else
+  {
+    AppMotor.DeviceDriverSet_Motor_control(/*direction_A*/ (A >= 0) ? direction_just : direction_back, /*speed_A*/ abs(A),
+                                           /*direction_B*/ (B >= 0) ? direction_just : direction_back, /*speed_B*/ abs(B), /*controlED*/ control_enable);
+  }
+}
+static void Sim_Start(SmartRobotCarFunctionalModel Mode)
+{
+  HostCar_Params Params;
+  Params.Grip[0] = Sim_Grip_A;
+  Params.Grip[1] = Sim_Grip_B;
+  HostCar_Reset(Params);
+  HostCar_Setup();
+  ApplicationFunctionSet_SmartRobotCarEmergencyStop();
+  Application_SmartRobotCarxxx0.Functional_Mode = Mode;
+}
+static SimResult Sim_Run(SmartRobotCarFunctionalModel Mode, const SimStep *Steps, int Count, unsigned long End_ms, bool Shaped)
+{
+  Sim_Start(Mode);
+  HostCar.Current_Peak = 0;
+  HostCar.Voltage_Min = HostCar_Param.Battery;
+  unsigned long start = millis();
+  int i = 0;
+  while (millis() - start < End_ms)
+  {
+    while (i + 1 < Count && millis() - start >= Steps[i + 1].Start_ms)
+    {
+      i++;
+    }
+    Sim_Drive(Steps[i].A, Steps[i].B, Shaped);
+    HostCar_Step(Sim_Loop);
+  }
+  SimResult r = {HostCar.Heading, HostCar.Current_Peak, HostCar.Voltage_Min, HostCar.X};
+  return r;
+}
+enum SimManoeuvre
+{
+  Sim_Stepped, //DeviceDriverSet_Motor_control, as before the shaper
+  Sim_Shaped,  //Through the shaper
+  Sim_Step,    //ApplicationFunctionSet_SmartRobotCarMotionStep into back-off, turn and forward, shaped from there
+};
+/*Heading turned between the start of the turn and the end of the run*/
+static double Sim_Obstacle(SimManoeuvre How)
+{
+  Sim_Start(ObstacleAvoidance_mode);
+  const SmartRobotCarMotionControl Direction[3] = {Backward, Right, Forward};
+  const int16_t Duty[2][2] = {{-Obstacle_Speed, -Obstacle_Speed}, {-Obstacle_Speed, Obstacle_Speed}};
+  const unsigned long Time[3] = {Obstacle_BackOff_Time, Obstacle_Turn_Time, 1000};
+  double turn_start = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    if (1 == i)
+    {
+      turn_start = HostCar.Heading;
+    }
+    if (Sim_Step == How)
+    {
+      ApplicationFunctionSet_SmartRobotCarMotionStep(Direction[i], Obstacle_Speed);
+    }
+    unsigned long start = millis();
+    while (millis() - start < Time[i])
+    {
+      if (Sim_Stepped == How && i < 2)
+      {
+        Sim_Drive(Duty[i][0], Duty[i][1], false);
+      }
+      else if (Sim_Stepped == How) //Forward with the heading hold, stepped
+      {
+        ApplicationFunctionSet_SmartRobotCarMotionStep(Direction[i], Obstacle_Speed);
+      }
+      else
+      {
+        ApplicationFunctionSet_SmartRobotCarMotionControl(Direction[i], Obstacle_Speed);
+        ApplicationFunctionSet_SmartRobotCarMotorShaper();
+      }
+      HostCar_Step(Sim_Loop);
+    }
+  }
+  return HostCar.Heading - turn_start;
+}
+static void Sim_Print(const char *Name, const SimResult &r)
+{
+  printf("  %-7s heading %+6.2f deg  peak current %4.2f A  lowest battery %4.2f V  distance %+5.2f m\n", Name, r.Heading, r.Current_Peak,
+         r.Voltage_Min, r.Distance_m);
+}
+
+/*Shaper alone：periods to reach a random target, and the largest overshoot past it*/
+static void Sim_Settle(const char *Name, const MotorShaper_Limits &Limits)
+{
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> duty(-255, 255);
+  MotorShaper_Wheel Wheel = {0, 0, 0};
+  int periods_max = 0;
+  double overshoot_max = 0;
+  for (int n = 0; n < Sim_Targets; n++)
+  {
+    q16_t from = Wheel.Duty;
+    Wheel.Target = Q16_FromInt(duty(random));
+    int periods = 0;
+    while (Wheel.Duty != Wheel.Target || Wheel.Accel != 0)
+    {
+      ApplicationFunctionSet_SmartRobotCarMotorShape(Wheel, Limits);
+      double past = (Wheel.Target > from) ? Q16_ToFloat(Wheel.Duty - Wheel.Target) : Q16_ToFloat(Wheel.Target - Wheel.Duty);
+      overshoot_max = max(overshoot_max, past);
+      periods++;
+    }
+    periods_max = max(periods_max, periods);
+  }
+  printf("  %-8s %d random targets：settled within %d ms, overshoot %.3f PWM\n", Name, Sim_Targets, periods_max * MotorShaper_Period,
+         overshoot_max);
+}
+
+int main(void)
+{
+  printf("Right tyres grip %.2f, left %.2f\n", Sim_Grip_A, Sim_Grip_B);
+  const SimStep Rocker[] = {{0, 250, 250}};
+  printf(" Rocker forward 0 -> 250, 1000 ms\n");
+  Sim_Print("step", Sim_Run(Rocker_mode, Rocker, 1, 1000, false));
+  Sim_Print("shaped", Sim_Run(Rocker_mode, Rocker, 1, 1000, true));
+  const SimStep Obstacle[] = {{0, -150, -150}, {500, -150, 150}, {900, 150, 150}};
+  printf(" Obstacle Backward 150 (500 ms), Right 150 (400 ms), Forward 150 (600 ms)\n");
+  Sim_Print("step", Sim_Run(ObstacleAvoidance_mode, Obstacle, 3, 1500, false));
+  Sim_Print("shaped", Sim_Run(ObstacleAvoidance_mode, Obstacle, 3, 1500, true));
+
+  printf(" Obstacle back-off and turn：Backward %d ms, Right %d ms, Forward\n", Obstacle_BackOff_Time, Obstacle_Turn_Time);
+  printf("  stepped %+6.1f deg  shaped %+6.1f deg  MotionStep %+6.1f deg\n", Sim_Obstacle(Sim_Stepped), Sim_Obstacle(Sim_Shaped),
+         Sim_Obstacle(Sim_Step));
+
+  printf(" Emergency stop from 250 (Rocker, shaped)\n");
+  Sim_Run(Rocker_mode, Rocker, 1, 1000, true);
+  int before[2] = {HostCar.Duty[0], HostCar.Duty[1]};
+  ApplicationFunctionSet_SmartRobotCarEmergencyStop();
+  HostCar_Step(100);
+  printf("  duty %d/%d -> %d/%d in the same pass\n", before[0], before[1], HostCar.Duty[0], HostCar.Duty[1]);
+
+  printf("Shaper alone\n");
+  Sim_Settle("Rocker", MotorShaper_LimitsSet[MotorShaper_Rocker]);
+  Sim_Settle("Cruise", MotorShaper_LimitsSet[MotorShaper_Cruise]);
+  Sim_Settle("Tracking", MotorShaper_LimitsSet[MotorShaper_Tracking]);
+  return 0;
+}
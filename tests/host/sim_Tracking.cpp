@@ -0,0 +1,151 @@
+/*
+  Line tracking simulation (ApplicationFunctionSet_Tracking)：
+  the centroid PID of TraceBased_mode against the three-sensor bang-bang it replaced, on stadium tracks of black tape
+  (two straights joined by half circles). Both drive the same simulated car (HostCar) from the start of a straight for
+  Sim_Laps laps；reported are the lap time, the RMS distance of the middle sensor from the tape centre and how often
+  the line was lost (all three sensors off the tape).
+*/
+#include "HostBench.h" //Standard headers before the Arduino min/max macros
+#include "ApplicationFunctionSet_xxx0.cpp"
+#include "HostCar.h"
+
+#define Sim_Laps 3
+#define Sim_Timeout 90000 //ms
+#define Sim_Loop 1000     //us per pass of loop()
+
+static double Stadium_L, Stadium_R; //Straight length, curve radius (m)
+static double Stadium_Distance(double X, double Y)
+{
+  double x = constrain(X, -Stadium_L / 2, Stadium_L / 2);
+  return hypot(X - x, Y) - Stadium_R;
+}
+
+/*The tracking before the change：speed 100 forward / spin right / spin left on the first sensor in S~E, blind sweep otherwise*/
+static void Legacy_Motor(int A, int B)
+{
+  AppMotor.DeviceDriverSet_Motor_control(A >= 0, abs(A), B >= 0, abs(B), control_enable);
+}
+static void Legacy_Tracking(void)
+{
+  static boolean timestamp = true;
+  static boolean BlindDetection = true;
+  static unsigned long MotorRL_time = 0;
+  int L = HostCar_Ir(0), M = HostCar_Ir(1), R = HostCar_Ir(2);
+  if (function_xxx(M, 250, 850))
+  {
+    Legacy_Motor(100, 100);
+    timestamp = true;
+    BlindDetection = true;
+  }
+  else if (function_xxx(R, 250, 850))
+  {
+    Legacy_Motor(-100, 100);
+    timestamp = true;
+    BlindDetection = true;
+  }
+  else if (function_xxx(L, 250, 850))
+  {
+    Legacy_Motor(100, -100);
+    timestamp = true;
+    BlindDetection = true;
+  }
+  else
+  {
+    if (timestamp == true)
+    {
+      timestamp = false;
+      MotorRL_time = millis();
+      Legacy_Motor(0, 0);
+    }
+    unsigned long t = millis() - MotorRL_time;
+    if ((function_xxx(t, 0, 200) || function_xxx(t, 1600, 2000)) && BlindDetection == true)
+      Legacy_Motor(-100, 100);
+    else if (function_xxx(t, 200, 1600) && BlindDetection == true)
+      Legacy_Motor(100, -100);
+    else if (function_xxx(t, 3000, 3500))
+    {
+      BlindDetection = false;
+      Legacy_Motor(0, 0);
+    }
+  }
+}
+
+struct SimResult
+{
+  int Laps;
+  double Lap_s;  //Mean lap time
+  double Rms_mm; //Middle sensor from the tape centre
+  int Lost;      //Line lost events
+};
+static SimResult Sim_Run(bool Legacy)
+{
+  HostCar_Reset(HostCar_Params());
+  HostCar_Line = Stadium_Distance;
+  HostCar.X = 0;
+  HostCar.Y = -Stadium_R;
+  HostCar_Setup();
+  for (int i = 0; i < 1500; i++) //Power up, gyro still
+  {
+    HostCar_Loop(Sim_Loop);
+  }
+  if (false == Legacy)
+  {
+    Serial.Feed("{\"N\":101,\"D1\":1}");
+  }
+  SimResult r = {0, 0, 0, 0};
+  double sum2 = 0;
+  long samples = 0;
+  bool lost = false, upper = false;
+  unsigned long start = millis(), lap = start;
+  while (r.Laps < Sim_Laps && millis() - start < Sim_Timeout)
+  {
+    if (Legacy)
+    {
+      Legacy_Tracking();
+      HostCar_Step(Sim_Loop);
+    }
+    else
+    {
+      HostCar_Loop(Sim_Loop);
+    }
+    double psi = -HostCar.Heading / RAD_TO_DEG;
+    double d = Stadium_Distance(HostCar.X + HostCar_Sensor_Ahead * cos(psi), HostCar.Y + HostCar_Sensor_Ahead * sin(psi));
+    sum2 += d * d;
+    samples++;
+    bool off = HostCar_Ir(0) < 250 && HostCar_Ir(1) < 250 && HostCar_Ir(2) < 250;
+    r.Lost += (off && !lost);
+    lost = off;
+    upper = upper || HostCar.Y > 0;
+    if (upper && HostCar.Y < 0 && HostCar.X >= 0) //Back on the start straight
+    {
+      upper = false;
+      r.Laps++;
+      lap = millis();
+    }
+  }
+  r.Lap_s = r.Laps ? (lap - start) / 1000.0 / r.Laps : 0;
+  r.Rms_mm = sqrt(sum2 / samples) * 1000;
+  return r;
+}
+static void Sim_Print(const char *Name, const SimResult &r)
+{
+  printf("  %-9s laps %d/%d  lap %6.2f s  RMS %5.1f mm  line lost %3d\n", Name, r.Laps, Sim_Laps, r.Lap_s, r.Rms_mm, r.Lost);
+}
+
+int main(void)
+{
+  const double Tracks[][2] = {{1.2, 0.35}, {0.8, 0.2}};
+  bool Pass = true;
+  for (const auto &t : Tracks)
+  {
+    Stadium_L = t[0];
+    Stadium_R = t[1];
+    printf("Stadium %.2f m straights, %.2f m curves (lap %.2f m)\n", Stadium_L, Stadium_R, 2 * Stadium_L + 2 * M_PI * Stadium_R);
+    SimResult Legacy = Sim_Run(true);
+    SimResult Pid = Sim_Run(false);
+    Sim_Print("bang-bang", Legacy);
+    Sim_Print("PID", Pid);
+    Pass = Pass && Pid.Laps == Sim_Laps;
+  }
+  return Pass ? 0 : 1;
+}
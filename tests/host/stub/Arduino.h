@@ -0,0 +1,279 @@
+/*
+  Host stand-in for the Arduino core：just enough for the sketch sources to build and run on a PC.
+  Time is simulated (HostArduino_Advance), Serial reads from an injected byte stream and collects what is written,
+  String reallocates on every growth like the AVR core's WString so heap traffic can be counted (HostHeap).
+*/
+#ifndef _HostArduino_H_
+#define _HostArduino_H_
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "avr/io.h"
+#include "avr/pgmspace.h"
+#include "avr/interrupt.h"
+#define ARDUINO 10813
+typedef bool boolean;
+typedef uint8_t byte;
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define _BV(b) (1 << (b))
+#define B00100000 0x20 //binary.h：the two IRremote uses
+#define B11011111 0xDF
+#define bit(b) (1UL << (b))
+#define lowByte(w) ((uint8_t)((w)&0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define F(x) x
+#define clockCyclesPerMicrosecond() (F_CPU / 1000000L)
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+
+/*Simulated time：only HostArduino_Advance() and delay() move it*/
+void HostArduino_Advance(unsigned long Micros);
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+
+/*Pins：writes are recorded and counted, analogRead() asks the simulation*/
+extern uint8_t HostArduino_Pin[20];
+extern unsigned long HostArduino_PinWrites; //digitalWrite() and analogWrite() calls
+extern int (*HostArduino_AnalogRead)(uint8_t Pin);
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+int analogRead(uint8_t);
+void analogWrite(uint8_t, int);
+unsigned long pulseIn(uint8_t, uint8_t, unsigned long Timeout = 1000000L);
+void attachInterrupt(uint8_t, void (*)(void), int Mode);
+void noInterrupts(void);
+void interrupts(void);
+char *ltoa(long, char *, int);
+char *ultoa(unsigned long, char *, int);
+char *utoa(unsigned int, char *, int);
+char *itoa(int, char *, int);
+
+/*Heap traffic of the String class：calls and bytes in use*/
+struct HostHeap
+{
+  static unsigned long Allocations; //malloc + realloc calls
+  static long Bytes;
+  static long Peak;
+  static void Reset(void) { Allocations = 0, Bytes = 0, Peak = 0; }
+};
+class String
+{
+public:
+  String(const char *Text = "") { Copy(Text, strlen(Text)); }
+  String(const String &Other) { Copy(Other.Buffer ? Other.Buffer : "", Other.Length); }
+  ~String() { Release(); }
+  String &operator=(const String &Other) { return (this == &Other) ? *this : Copy(Other.Buffer ? Other.Buffer : "", Other.Length); }
+  String &operator=(const char *Text) { return Copy(Text, strlen(Text)); }
+  String &operator+=(char c) { return Concat(&c, 1); }
+  String &operator+=(const char *Text) { return Concat(Text, strlen(Text)); }
+  String &operator+=(const String &Other) { return Concat(Other.Buffer ? Other.Buffer : "", Other.Length); }
+  bool equals(const char *Text) const { return 0 == strcmp(c_str(), Text); }
+  const char *c_str(void) const { return Buffer ? Buffer : ""; }
+  unsigned int length(void) const { return Length; }
+  char operator[](unsigned int i) const { return c_str()[i]; }
+  bool reserve(unsigned int Size)
+  {
+    if (Buffer && Capacity >= Size)
+    {
+      return true;
+    }
+    char *p = (char *)realloc(Buffer, Size + 1); //WString::changeBuffer：exactly the size asked for
+    HostHeap::Allocations++;
+    HostHeap::Bytes += (long)Size - (Buffer ? (long)Capacity : -1);
+    if (HostHeap::Bytes > HostHeap::Peak)
+    {
+      HostHeap::Peak = HostHeap::Bytes;
+    }
+    Buffer = p;
+    Capacity = Size;
+    return true;
+  }
+
+private:
+  String &Copy(const char *Text, unsigned int n)
+  {
+    reserve(n);
+    memcpy(Buffer, Text, n);
+    Buffer[Length = n] = '\0';
+    return *this;
+  }
+  String &Concat(const char *Text, unsigned int n)
+  {
+    reserve(Length + n);
+    memcpy(Buffer + Length, Text, n);
+    Buffer[Length += n] = '\0';
+    return *this;
+  }
+  void Release(void)
+  {
+    if (Buffer)
+    {
+      HostHeap::Bytes -= Capacity + 1;
+      free(Buffer);
+    }
+  }
+  char *Buffer = NULL;
+  unsigned int Capacity = 0;
+  unsigned int Length = 0;
+};
+
+class Print
+{
+public:
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const uint8_t *p, size_t n)
+  {
+    for (size_t i = 0; i < n; i++)
+      write(p[i]);
+    return n;
+  }
+  size_t write(const char *Text) { return write((const uint8_t *)Text, strlen(Text)); }
+  size_t print(const char *Text) { return write(Text); }
+  size_t print(const String &Text) { return write(Text.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long Value, int Base = 10)
+  {
+    char s[34];
+    return write(ltoa(Value, s, Base));
+  }
+  size_t print(int Value, int Base = 10) { return print((long)Value, Base); }
+  size_t print(unsigned long Value, int Base = 10)
+  {
+    char s[34];
+    return write(ultoa(Value, s, Base));
+  }
+  size_t print(unsigned int Value, int Base = 10) { return print((unsigned long)Value, Base); }
+  size_t print(double Value, int = 2)
+  {
+    char s[32];
+    snprintf(s, sizeof(s), "%.2f", Value);
+    return write(s);
+  }
+  template <class T>
+  size_t println(T Value)
+  {
+    return print(Value) + write("\r\n");
+  }
+  size_t println(void) { return write("\r\n"); }
+};
+class Stream : public Print
+{
+};
+/*
+  Serial：Rx is fed by the test, Tx collects everything written (Serial.Tx).
+  With Timed set the wire runs at Baud (10 bits a byte)：fed bytes arrive one byte time apart, the core's 64-byte TX buffer
+  drains one byte per byte time and a write into a full buffer waits like the core's (Tx_Blocked_us). Polling
+  availableForWrite() on a full buffer costs 1us, so a caller spinning on it moves the clock.
+*/
+#define HostSerial_TxBuffer 64
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long Baud) { this->Baud = Baud; }
+  void end(void) {}
+  int available(void)
+  {
+    size_t n = Rx.size();
+    while (Timed && n > RxIndex && RxAt[n - 1] > micros())
+    {
+      n--;
+    }
+    return (int)(n - RxIndex);
+  }
+  int read(void) { return (available() > 0) ? (uint8_t)Rx[RxIndex++] : -1; }
+  int peek(void) { return (available() > 0) ? (uint8_t)Rx[RxIndex] : -1; }
+  int availableForWrite(void)
+  {
+    if (false == Timed)
+    {
+      return HostSerial_TxBuffer - 1;
+    }
+    int room = HostSerial_TxBuffer - 1 - TxPending();
+    if (room <= 0)
+    {
+      HostArduino_Advance(1);
+      Tx_Blocked_us += 1;
+    }
+    return max(room, 0);
+  }
+  void flush(void)
+  {
+    while (Timed && TxPending() > 0)
+    {
+      TxWait();
+    }
+  }
+  size_t write(uint8_t c) override
+  {
+    if (Timed)
+    {
+      if (TxPending() >= HostSerial_TxBuffer - 1)
+      {
+        TxWait();
+      }
+      Tx_Done_us = max(Tx_Done_us, micros()) + ByteTime();
+    }
+    Tx += (char)c;
+    return 1;
+  }
+  using Print::write;
+  operator bool() { return true; }
+  void Feed(const char *p, size_t n)
+  {
+    Rx.erase(0, RxIndex);
+    RxAt.erase(RxAt.begin(), RxAt.begin() + min(RxIndex, RxAt.size()));
+    RxIndex = 0;
+    Rx.append(p, n);
+    unsigned long at = RxAt.empty() ? micros() : max(RxAt.back(), micros());
+    for (size_t i = 0; i < n; i++)
+    {
+      RxAt.push_back(at += ByteTime());
+    }
+  }
+  void Feed(const char *Text) { Feed(Text, strlen(Text)); }
+  unsigned long ByteTime(void) { return (10000000UL + Baud / 2) / Baud; } //us
+  std::string Rx, Tx;
+  std::vector<unsigned long> RxAt; //Arrival of each Rx byte (Timed)
+  size_t RxIndex = 0;
+  unsigned long Baud = 9600;
+  bool Timed = false;
+  unsigned long Tx_Done_us = 0;    //The last byte written leaves the wire (Timed)
+  unsigned long Tx_Blocked_us = 0; //Time spent waiting for room in the TX buffer
+
+private:
+  int TxPending(void)
+  {
+    return (Tx_Done_us > micros()) ? (int)((Tx_Done_us - micros() + ByteTime() - 1) / ByteTime()) : 0;
+  }
+  void TxWait(void) //Until the byte on the wire is out
+  {
+    unsigned long wait = (Tx_Done_us - micros()) - (unsigned long)(TxPending() - 1) * ByteTime();
+    HostArduino_Advance(wait);
+    Tx_Blocked_us += wait;
+  }
+};
+extern HardwareSerial Serial;
+#endif
@@ -0,0 +1,28 @@
+/*Host stand-in：1KB of EEPROM in RAM, erased (0xFF) at start*/
+#ifndef _HostEEPROM_H_
+#define _HostEEPROM_H_
+#include <stdint.h>
+#include <string.h>
+struct EEPROMClass
+{
+  uint8_t Cell[1024];
+  EEPROMClass() { memset(Cell, 0xFF, sizeof(Cell)); }
+  uint8_t read(int Address) { return Cell[Address]; }
+  void write(int Address, uint8_t Value) { Cell[Address] = Value; }
+  void update(int Address, uint8_t Value) { Cell[Address] = Value; }
+  template <class T>
+  T &get(int Address, T &Value)
+  {
+    memcpy(&Value, Cell + Address, sizeof(T));
+    return Value;
+  }
+  template <class T>
+  const T &put(int Address, const T &Value)
+  {
+    memcpy(Cell + Address, &Value, sizeof(T));
+    return Value;
+  }
+  uint16_t length(void) { return sizeof(Cell); }
+};
+extern EEPROMClass EEPROM;
+#endif
@@ -0,0 +1,37 @@
+/*Host stand-in：the LED calls do nothing*/
+#ifndef _HostFastLED_H_
+#define _HostFastLED_H_
+#include "Arduino.h"
+#define WS2812 0
+#define NEOPIXEL 1
+#define GRB 0
+struct CRGB
+{
+  uint8_t r, g, b;
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint32_t Colour) : r(Colour >> 16), g(Colour >> 8), b(Colour) {}
+  CRGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+  enum
+  {
+    Black = 0x000000,
+    Red = 0xFF0000,
+    Green = 0x008000,
+    Blue = 0x0000FF,
+    Yellow = 0xFFFF00,
+    Violet = 0xEE82EE,
+    White = 0xFFFFFF,
+  };
+};
+struct CFastLED
+{
+  template <int Type, int Pin, int Order>
+  void addLeds(CRGB *, int) {}
+  template <int Type, int Pin>
+  void addLeds(CRGB *, int) {}
+  void setBrightness(uint8_t) {}
+  void show(void) {}
+  void clear(bool = false) {}
+  void showColor(const CRGB &) {}
+};
+extern CFastLED FastLED;
+#endif
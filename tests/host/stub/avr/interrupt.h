@@ -0,0 +1,6 @@
+#ifndef _HostAvrInterrupt_H_
+#define _HostAvrInterrupt_H_
+#define ISR(v) extern "C" void v(void)
+#define cli()
+#define sei()
+#endif
@@ -0,0 +1,83 @@
+/*Host stand-in：the ATmega328P registers the sketch touches, as plain variables*/
+#ifndef _HostAvrIo_H_
+#define _HostAvrIo_H_
+#include <stdint.h>
+#define F_CPU 16000000UL
+#define HostAvr_Reg8(n) extern volatile uint8_t n;
+#define HostAvr_Reg16(n) extern volatile uint16_t n;
+HostAvr_Reg8(PORTB) HostAvr_Reg8(PORTC) HostAvr_Reg8(PORTD) HostAvr_Reg8(DDRB) HostAvr_Reg8(DDRC) HostAvr_Reg8(DDRD)
+HostAvr_Reg8(PINB) HostAvr_Reg8(PINC) HostAvr_Reg8(PIND)
+HostAvr_Reg8(PCICR) HostAvr_Reg8(PCMSK0) HostAvr_Reg8(PCMSK1) HostAvr_Reg8(PCMSK2) HostAvr_Reg8(PCIFR)
+HostAvr_Reg8(ADMUX) HostAvr_Reg8(ADCSRA) HostAvr_Reg8(ADCSRB) HostAvr_Reg8(ADCL) HostAvr_Reg8(ADCH) HostAvr_Reg8(DIDR0)
+HostAvr_Reg8(TCCR0A) HostAvr_Reg8(TCCR0B) HostAvr_Reg8(OCR0A) HostAvr_Reg8(OCR0B)
+HostAvr_Reg8(TCCR1A) HostAvr_Reg8(TCCR1B) HostAvr_Reg8(TCCR1C) HostAvr_Reg8(TIMSK1) HostAvr_Reg8(TIFR1)
+HostAvr_Reg8(TCCR2A) HostAvr_Reg8(TCCR2B) HostAvr_Reg8(OCR2A) HostAvr_Reg8(OCR2B) HostAvr_Reg8(TIMSK2) HostAvr_Reg8(TCNT2)
+HostAvr_Reg8(TWBR) HostAvr_Reg8(TWSR) HostAvr_Reg8(TWCR) HostAvr_Reg8(TWDR) HostAvr_Reg8(TWAR) HostAvr_Reg8(SREG)
+HostAvr_Reg8(UCSR0A) HostAvr_Reg8(UCSR0B) HostAvr_Reg8(UCSR0C) HostAvr_Reg8(UDR0) HostAvr_Reg8(UBRR0H) HostAvr_Reg8(UBRR0L)
+HostAvr_Reg16(OCR1A) HostAvr_Reg16(OCR1B) HostAvr_Reg16(ICR1) HostAvr_Reg16(TCNT1) HostAvr_Reg16(ADC) HostAvr_Reg16(UBRR0)
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PC0 0
+#define PC4 4
+#define PC5 5
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define PCIE0 0
+#define PCIE1 1
+#define PCINT4 4
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define REFS0 6
+#define ADLAR 5
+#define MUX0 0
+#define COM0A1 7
+#define COM0B1 5
+#define COM1A1 7
+#define COM1B1 5
+#define COM2A1 7
+#define COM2B1 5
+#define WGM20 0
+#define WGM21 1
+#define WGM22 3
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define OCIE2A 1
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWEN 2
+#define TWIE 0
+#define TWPS0 0
+#define TWPS1 1
+#define UDRIE0 5
+#define UDRE0 5
+#define TXC0 6
+#define U2X0 1
+#define SREG_I 7
+#endif
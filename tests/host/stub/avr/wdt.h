@@ -0,0 +1,6 @@
+#ifndef _HostAvrWdt_H_
+#define _HostAvrWdt_H_
+#define WDTO_2S 7
+void wdt_reset(void);
+void wdt_enable(int);
+#endif
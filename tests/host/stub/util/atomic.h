@@ -0,0 +1,5 @@
+#ifndef _HostUtilAtomic_H_
+#define _HostUtilAtomic_H_
+#define ATOMIC_BLOCK(x) for (int HostAtomic = 1; HostAtomic; HostAtomic = 0)
+#define ATOMIC_RESTORESTATE 0
+#endif
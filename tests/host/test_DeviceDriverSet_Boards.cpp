@@ -0,0 +1,72 @@
+/*
+  Board revisions (DeviceDriverSet_Board03, DeviceDriverSet_Board04)：DeviceDriverSet_xxx0.cpp compiles its drivers for
+  DeviceDriverSet_Board only, so the other revision is instantiated here and a pin map typo in it fails this build.
+  Each board is then run through the pins it names：
+  - Motor：the TB6612 outputs land on its STBY/AIN/PWMA/BIN/PWMB pins
+  - ITR20001：L/M/R are read from the ADC scan channels of its A0~A2 pins
+*/
+#include <type_traits> //Standard headers before the Arduino min/max macros
+#include "HostTest.h"
+#include "DeviceDriverSet_xxx0.cpp"
+
+typedef std::conditional<std::is_same<DeviceDriverSet_Board, DeviceDriverSet_Board03>::value, DeviceDriverSet_Board04,
+                         DeviceDriverSet_Board03>::type Test_OtherBoard;
+template class DeviceDriverSet_Key<Test_OtherBoard>;
+template class DeviceDriverSet_ITR20001<Test_OtherBoard>;
+template class DeviceDriverSet_Motor<Test_OtherBoard>;
+template class DeviceDriverSet_ULTRASONIC<Test_OtherBoard>;
+template class DeviceDriverSet_Servo<Test_OtherBoard>;
+
+template <class Board>
+static void Test_Motor(const char *Name)
+{
+  DeviceDriverSet_Motor<Board> Motor;
+  memset(HostArduino_Pin, 0, sizeof(HostArduino_Pin));
+  Motor.DeviceDriverSet_Motor_Init();
+  Motor.DeviceDriverSet_Motor_control(direction_back, 40, direction_just, 200, control_enable);
+  Test_Expect(HostArduino_Pin[Board::PIN_Motor_STBY] == HIGH, "%s：STBY (D%u) not HIGH", Name, Board::PIN_Motor_STBY);
+  Test_Expect(HostArduino_Pin[Board::PIN_Motor_AIN_1] == LOW, "%s：AIN_1 (D%u) not LOW", Name, Board::PIN_Motor_AIN_1);
+  Test_Expect(HostArduino_Pin[Board::PIN_Motor_PWMA] == 40, "%s：PWMA (D%u) %u, expected 40", Name, Board::PIN_Motor_PWMA,
+              HostArduino_Pin[Board::PIN_Motor_PWMA]);
+  Test_Expect(HostArduino_Pin[Board::PIN_Motor_BIN_1] == HIGH, "%s：BIN_1 (D%u) not HIGH", Name, Board::PIN_Motor_BIN_1);
+  Test_Expect(HostArduino_Pin[Board::PIN_Motor_PWMB] == 200, "%s：PWMB (D%u) %u, expected 200", Name, Board::PIN_Motor_PWMB,
+              HostArduino_Pin[Board::PIN_Motor_PWMB]);
+  Motor.DeviceDriverSet_Motor_control(direction_just, 40, direction_back, 200, control_enable);
+  Test_Expect(HostArduino_Pin[Board::PIN_Motor_AIN_1] == HIGH && HostArduino_Pin[Board::PIN_Motor_BIN_1] == LOW,
+              "%s：directions not swapped", Name);
+  Motor.DeviceDriverSet_Motor_control(direction_just, 0, direction_just, 0, control_disable);
+  Test_Expect(HostArduino_Pin[Board::PIN_Motor_STBY] == LOW, "%s：STBY (D%u) not LOW after control_disable", Name, Board::PIN_Motor_STBY);
+}
+
+template <class Board>
+static void Test_ITR20001(const char *Name)
+{
+  DeviceDriverSet_ITR20001<Board> ITR20001;
+  for (uint8_t i = 0; i < ADC_Channels; i++)
+  {
+    ADC_Snapshot[ADC_Front][i] = 100 + i; //Channel i reads 100 + i
+  }
+  int L, M, R;
+  ITR20001.DeviceDriverSet_ITR20001_Get(&L, &M, &R);
+  Test_Expect(L == 100 + Board::PIN_ITR20001xxxL - A0, "%s：L %d, expected A%d", Name, L, Board::PIN_ITR20001xxxL - A0);
+  Test_Expect(M == 100 + Board::PIN_ITR20001xxxM - A0, "%s：M %d, expected A%d", Name, M, Board::PIN_ITR20001xxxM - A0);
+  Test_Expect(R == 100 + Board::PIN_ITR20001xxxR - A0, "%s：R %d, expected A%d", Name, R, Board::PIN_ITR20001xxxR - A0);
+  Test_Expect(L == ITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_L() && M == ITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_M() &&
+                  R == ITR20001.DeviceDriverSet_ITR20001_getAnaloguexxx_R(),
+              "%s：getAnaloguexxx_L/M/R differ from Get", Name);
+}
+
+template <class Board>
+static void Test_Board(const char *Name)
+{
+  Test_Motor<Board>(Name);
+  Test_ITR20001<Board>(Name);
+}
+
+int main(void)
+{
+  Test_Board<DeviceDriverSet_Board03>("DeviceDriverSet_Board03");
+  Test_Board<DeviceDriverSet_Board04>("DeviceDriverSet_Board04");
+  printf("DeviceDriverSet_Boards：%s (%d failures)\n", Test_Failures ? "FAIL" : "ok", Test_Failures);
+  return Test_Failures ? 1 : 0;
+}
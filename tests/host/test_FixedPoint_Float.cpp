@@ -0,0 +1,106 @@
+/*
+  Q16.16 control paths against the float code they replaced：
+  - yaw step (MPU6050_getdata_Integrate)：bit exact with the Q28 sum it claims to carry, and within the scale
+    quantisation of -(gz - gzo) / 131 * dt
+  - heading correction (ApplicationFunctionSet_HeadingHoldCorrection)：within rounding of
+    Kp * error + Ki * Integral + Kd * (Yaw - Yaw_last) / dt in float
+  - battery voltage (Voltage_Scale)：within 4mV of analogRead * 0.0375 * 1.08 and the same low voltage decision for
+    every ADC code
+*/
+#include <random>
+#include <math.h>
+#include "HostTest.h"
+#include "HostBench.h" //Standard headers before the Arduino min/max macros
+#include "ApplicationFunctionSet_xxx0.cpp"
+
+#define Test_YawHour 360000L  //Samples at 100Hz
+#define Test_YawSteady 30000L //Five minutes at 100°/s, short of the ±32768° Q16 range
+
+/*Yaw：the same rates into MPU6050_getdata_Integrate, the float integration it replaced and a double reference*/
+static void Test_Yaw(const char *Name, long (*Rate)(std::mt19937 &), long Samples)
+{
+  std::mt19937 random(1);
+  q16_t agz = 0;
+  uint16_t fraction = 0;
+  long long q28 = 0;  //Exact sum of the Q28 steps
+  double exact = 0;   //-Σ rate / 131 * 0.01
+  double bound = 0;   //Scale quantisation of MPU6050_getdata_Scale
+  float legacy = 0;   //agz -= rate / 131.0 * dt
+  const float dt = 0.01;
+  const double scale_error = fabs(MPU6050_getdata_Scale / 268435456.0 - 0.01 / 131);
+  for (long i = 0; i < Samples; i++)
+  {
+    long rate = Rate(random);
+    MPU6050_getdata_Integrate(agz, fraction, rate);
+    q28 -= rate * MPU6050_getdata_Scale;
+    exact -= rate / 131.0 * 0.01;
+    bound += labs(rate) * scale_error;
+    legacy -= rate / 131.0 * dt;
+    Test_Expect((long long)agz * 4096 + fraction == q28, "%s：sample %ld, Q16 %ld + %u/4096 is not the Q28 sum %lld", Name, i, (long)agz,
+                fraction, q28);
+  }
+  double error = agz / 65536.0 - exact; //Past 2^24 LSB a float no longer holds every Q16 step
+  Test_Expect(fabs(error) <= bound + 1 / 65536.0, "%s：yaw off by %g°, bound %g°", Name, error, bound);
+  printf("  yaw, %s：Q16 %+.5f° off (bound %.5f°), float %+.5f° off\n", Name, error, bound, legacy - exact);
+}
+static long Test_RateTurning(std::mt19937 &random) //Turns both ways up to 250°/s
+{
+  return (long)(random() % 65535) - 32767;
+}
+static long Test_RateSteady(std::mt19937 &random) //One way at 100°/s
+{
+  return 13100 + (long)(random() % 13) - 6;
+}
+
+/*Heading correction：operating range of each gain set*/
+static void Test_Heading(const char *Name, const HeadingHold_Gains &Gains, float Kp, float Ki, float Kd)
+{
+  std::mt19937 random(2);
+  long exact = 0;
+  double worst = 0;
+  const long N = 1000000;
+  for (long i = 0; i < N; i++)
+  {
+    q16_t error = (q16_t)(random() % (90L * 65536)) - 45L * 65536;                           //±45°
+    q16_t Integral = (q16_t)(random() % (2UL * Gains.IntegralMax + 1)) - Gains.IntegralMax; //Within its bound
+    q16_t dYaw = (q16_t)(random() % (6L * 65536)) - 3L * 65536;                              //±3° per period
+    unsigned long dt = HeadingHold_Period + random() % 91;                                   //10~100ms
+    int correction = ApplicationFunctionSet_HeadingHoldCorrection(Gains, error, Integral, dYaw, dt);
+    float Output = Kp * Q16_ToFloat(error) + Ki * Q16_ToFloat(Integral) + Kd * Q16_ToFloat(dYaw) / (dt / 1000.0f);
+    Output = constrain(Output, -512.0f, 512.0f);
+    double off = fabs(correction - Output);
+    worst = max(worst, off);
+    exact += (correction == (int)floorf(Output + 0.5f));
+    Test_Expect(off <= 0.5 + 0.01, "%s：correction %d for float %f (error %ld, Integral %ld, dYaw %ld, dt %lu)", Name, correction, Output,
+                (long)error, (long)Integral, (long)dYaw, dt);
+  }
+  printf("  heading correction, %s：%.4f%% equal to the rounded float, worst %.4f PWM\n", Name, 100.0 * exact / N, worst);
+}
+
+/*Battery voltage：every ADC code*/
+static void Test_Voltage(void)
+{
+  double worst = 0;
+  for (uint16_t adc = 0; adc < 1024; adc++)
+  {
+    q16_t Voltage = Voltage_Scale * adc;
+    float legacy = adc * 0.0375;
+    legacy = legacy + (legacy * 0.08); //Compensation 8%
+    double off = fabs(Q16_ToFloat(Voltage) - legacy);
+    worst = max(worst, off);
+    Test_Expect(off <= 0.004, "ADC %u：%f V against %f V", adc, Q16_ToFloat(Voltage), legacy);
+    Test_Expect((Voltage < Application_FunctionSet.VoltageDetection) == (legacy < 7.00f), "ADC %u：low voltage decision differs", adc);
+  }
+  printf("  voltage：worst %.2f mV over ADC 0~1023, low voltage decision identical\n", worst * 1000);
+}
+
+int main(void)
+{
+  Test_Yaw("turning", Test_RateTurning, Test_YawHour);
+  Test_Yaw("steady 100°/s", Test_RateSteady, Test_YawSteady);
+  Test_Heading("Rocker", HeadingHold_GainSet[HeadingHold_Rocker], 10.0, 20.0, 0.3);
+  Test_Heading("Cruise", HeadingHold_GainSet[HeadingHold_Cruise], 2.0, 4.0, 0.1);
+  Test_Voltage();
+  printf("FixedPoint_Float：%s (%d failures)\n", Test_Failures ? "FAIL" : "ok", Test_Failures);
+  return Test_Failures ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+/*
+  FixedPoint_Q16.h unit test：every operation against a 64 bit reference.
+  Add/Sub/Mul must be bit exact with saturation at Q16_Max/Q16_Min (Mul rounds towards -∞ like (a * b) >> 16),
+  Q16_ToInt rounds halves up and saturates at the top of the range, FromInt/FromRatio/DivInt are exact.
+*/
+#include <random>
+#include "HostTest.h"
+#include "FixedPoint_Q16.h"
+
+static q16_t Ref_Saturate(long long Value)
+{
+  return (Value > Q16_Max) ? Q16_Max : (Value < Q16_Min) ? Q16_Min : (q16_t)Value;
+}
+static q16_t Ref_Mul(q16_t a, q16_t b)
+{
+  return Ref_Saturate(((long long)a * b) >> 16); //Arithmetic shift：towards -∞
+}
+static void Test_Arithmetic(q16_t a, q16_t b)
+{
+  Test_Expect(Q16_Add(a, b) == Ref_Saturate((long long)a + b), "Q16_Add(%ld, %ld) = %ld", (long)a, (long)b, (long)Q16_Add(a, b));
+  Test_Expect(Q16_Sub(a, b) == Ref_Saturate((long long)a - b), "Q16_Sub(%ld, %ld) = %ld", (long)a, (long)b, (long)Q16_Sub(a, b));
+  Test_Expect(Q16_Mul(a, b) == Ref_Mul(a, b), "Q16_Mul(%ld, %ld) = %ld, expected %ld", (long)a, (long)b, (long)Q16_Mul(a, b), (long)Ref_Mul(a, b));
+}
+
+int main(void)
+{
+  /*Edge values：zero, ±1 LSB, ±1, the 16 bit halves and the ends of the range*/
+  const q16_t Edge[] = {0, 1, -1, Q16_One, -Q16_One, Q16_One + 1, -Q16_One - 1, 0x7FFF, 0x8000, -0x8000, 0xFFFF, -0xFFFF,
+                        0x7FFF0000L, -0x7FFF0000L, 0x00FF00FFL, (q16_t)0x80000001L, Q16_Max - 1, Q16_Max, Q16_Min, 123456789L, -987654321L};
+  for (q16_t a : Edge)
+  {
+    for (q16_t b : Edge)
+    {
+      Test_Arithmetic(a, b);
+    }
+  }
+  /*Random operands over the full range and scaled down towards the small values the control loops use*/
+  std::mt19937 Random(1);
+  for (long i = 0; i < 2000000; i++)
+  {
+    q16_t a = (q16_t)Random(), b = (q16_t)Random();
+    if (i % 4 == 1)
+      a >>= Random() % 31;
+    else if (i % 4 == 2)
+      a >>= Random() % 31, b >>= Random() % 31;
+    Test_Arithmetic(a, b);
+  }
+
+  /*Q16_ToInt：halves up, exact over the whole range, saturated where the result leaves int16_t*/
+  Test_Expect(Q16_ToInt(Q16_FromFloat(2.5)) == 3, "ToInt(2.5) = %d", Q16_ToInt(Q16_FromFloat(2.5)));
+  Test_Expect(Q16_ToInt(Q16_FromFloat(-2.5)) == -2, "ToInt(-2.5) = %d", Q16_ToInt(Q16_FromFloat(-2.5)));
+  Test_Expect(Q16_ToInt(Q16_FromFloat(-2.6)) == -3, "ToInt(-2.6) = %d", Q16_ToInt(Q16_FromFloat(-2.6)));
+  Test_Expect(Q16_ToInt(Q16_Max) == 32767, "ToInt(Q16_Max) = %d", Q16_ToInt(Q16_Max));
+  Test_Expect(Q16_ToInt(Q16_Min) == -32768, "ToInt(Q16_Min) = %d", Q16_ToInt(Q16_Min));
+  for (long long v = Q16_Max; v >= (long long)Q16_Max - 0x30000; v--)
+  {
+    long long expected = (v + 0x8000) >> 16;
+    Test_Expect(Q16_ToInt((q16_t)v) == (expected > 32767 ? 32767 : expected), "ToInt(%lld) = %d", v, Q16_ToInt((q16_t)v));
+  }
+  for (long i = 0; i < 1000000; i++)
+  {
+    q16_t v = (q16_t)Random();
+    long long expected = ((long long)v + 0x8000) >> 16;
+    Test_Expect(Q16_ToInt(v) == (expected > 32767 ? 32767 : expected), "ToInt(%ld) = %d", (long)v, Q16_ToInt(v));
+  }
+
+  /*Conversions*/
+  for (long n = -32768; n <= 32767; n++)
+  {
+    Test_Expect(Q16_FromInt(n) == n * 65536L, "FromInt(%ld)", n);
+    Test_Expect(Q16_ToInt(Q16_FromInt(n)) == n, "ToInt(FromInt(%ld))", n);
+  }
+  Test_Expect(Q16_FromRatio(10, 1000) == 655, "FromRatio(10, 1000) = %ld", (long)Q16_FromRatio(10, 1000));
+  Test_Expect(Q16_FromRatio(-1, 3) == -21845, "FromRatio(-1, 3) = %ld", (long)Q16_FromRatio(-1, 3));
+  Test_Expect(Q16_FromFloat(0.1) == 6554, "FromFloat(0.1) = %ld", (long)Q16_FromFloat(0.1));
+  Test_Expect(Q16_FromFloat(-0.1) == -6554, "FromFloat(-0.1) = %ld", (long)Q16_FromFloat(-0.1));
+  Test_Expect(Q16_DivInt(Q16_FromInt(-7), 2) == Q16_FromFloat(-3.5), "DivInt(-7, 2)");
+  Test_Expect(Q16_MulInt(Q16_FromFloat(1.5), -3) == Q16_FromFloat(-4.5), "MulInt(1.5, -3)");
+  Test_Expect(Q16_MulInt(Q16_FromInt(20000), 2) == Q16_Max, "MulInt saturates");
+
+  printf("FixedPoint_Q16：%s (%d failures)\n", Test_Failures ? "FAIL" : "ok", Test_Failures);
+  return Test_Failures ? 1 : 0;
+}